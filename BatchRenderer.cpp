@@ -0,0 +1,143 @@
+#include "BatchRenderer.h"
+#include "graphicwidget.h"
+#include "Parser.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QProcess>
+#include <QTextStream>
+
+const char* const BatchRenderer::WorkerOption = "worker";
+
+bool BatchRenderer::readJobs(const QString& fileName, QVector<Job>& jobs, QStringList& errors)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream in(&file);
+    int lineNumber = 0;
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        Job job;
+        job.line = lineNumber;
+        if (parseJob(line, job))
+            jobs.append(job);
+        else
+            errors.append(QString("%1:%2: некорректное задание").arg(fileName).arg(lineNumber));
+    }
+    return true;
+}
+
+bool BatchRenderer::parseJob(const QString& line, Job& job)
+{
+    const QStringList fields = line.split(';');
+    if (fields.size() < 6)
+        return false;
+
+    job.fileName = fields[0].trimmed();
+    if (job.fileName.isEmpty())
+        return false;
+
+    double* bounds[] = {&job.xMin, &job.xMax, &job.yMin, &job.yMax};
+    for (int i = 0; i < 4; ++i)
+    {
+        bool ok = false;
+        *bounds[i] = fields[i + 1].trimmed().toDouble(&ok);
+        if (!ok)
+            return false;
+    }
+    if (!(job.xMin < job.xMax) || !(job.yMin < job.yMax))
+        return false;
+
+    for (int i = 5; i < fields.size(); ++i)
+    {
+        const QString expression = fields[i].trimmed();
+        if (expression.isEmpty())
+            return false;
+        job.expressions.append(expression);
+    }
+    return true;
+}
+
+int BatchRenderer::render(const QVector<Job>& jobs, const QSize& size, int worker, int workers)
+{
+    // Цвета графиков: первые два — как в окне редактора
+    static const QColor palette[] = {
+        QColor("#1E2A78"), QColor("#FF2E4C"), QColor("#2E8B57"), QColor("#FF8C00")
+    };
+    const int paletteSize = sizeof(palette) / sizeof(palette[0]);
+
+    // Один виджет на процесс: между заданиями меняются только функции и диапазон.
+    // Платформа offscreen рисует в памяти, окно на экране не появляется
+    GraphicWidget widget;
+    widget.resize(size);
+    widget.show();
+    // Ядра уже заняты другими исполнителями
+    if (workers > 1)
+        widget.setSamplingThreads(1);
+
+    int failures = 0;
+    for (int i = worker; i < jobs.size(); i += workers)
+    {
+        const Job& job = jobs[i];
+        widget.clearFunctions();
+        widget.setRange(job.xMin, job.xMax, job.yMin, job.yMax);
+
+        bool ok = true;
+        for (int k = 0; k < job.expressions.size() && ok; ++k)
+        {
+            // Выражения в отчётах повторяются: разбор берётся из кэша
+            std::shared_ptr<const Function> func = ParserCache::instance().parse(job.expressions[k]);
+            if (func)
+                widget.addFunction(func, palette[k % paletteSize]);
+            else
+                ok = false;
+        }
+        if (!ok)
+        {
+            qWarning().noquote() << QString("строка %1: некорректная функция").arg(job.line);
+            ++failures;
+            continue;
+        }
+
+        widget.finishSampling();
+        if (!widget.save(job.fileName))
+        {
+            qWarning().noquote() << QString("строка %1: не удалось сохранить %2").arg(job.line).arg(job.fileName);
+            ++failures;
+        }
+    }
+    widget.clearFunctions();
+    return failures;
+}
+
+int BatchRenderer::runWorkers(const QStringList& arguments, int workers)
+{
+    QVector<QProcess*> processes;
+    for (int k = 0; k < workers; ++k)
+    {
+        QProcess* process = new QProcess;
+        // Сообщения исполнителей идут прямо в консоль
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(),
+                       QStringList(arguments)
+                           << QString("--%1").arg(WorkerOption)
+                           << QString("%1/%2").arg(k).arg(workers));
+        processes.append(process);
+    }
+
+    int failed = 0;
+    for (QProcess* process : processes)
+    {
+        if (!process->waitForFinished(-1) ||
+            process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0)
+            ++failed;
+    }
+    qDeleteAll(processes);
+    return failed;
+}
@@ -0,0 +1,46 @@
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Пакетная отрисовка графиков без окна. Файл заданий — по заданию на строку:
+//   файл; xmin; xmax; ymin; ymax; выражение[; выражение ...]
+// Пустые строки и строки с # в начале пропускаются. Формат результата
+// выбирается по расширению файла (png, pdf, jpg, bmp).
+//
+// Виджеты живут только в главном потоке процесса, поэтому графики рисуются
+// параллельно в нескольких процессах-исполнителях: каждый со своим
+// QCustomPlot берёт задания с номерами worker, worker + workers, ...
+class BatchRenderer
+{
+public:
+    struct Job {
+        int line;
+        QString fileName;
+        double xMin;
+        double xMax;
+        double yMin;
+        double yMax;
+        QStringList expressions;
+    };
+
+    // Возвращает false, если файл не открылся; ошибки в строках
+    // собираются в errors, такие строки пропускаются
+    static bool readJobs(const QString& fileName, QVector<Job>& jobs, QStringList& errors);
+    // Отрисовка своей доли заданий в этом процессе; возвращает число неудач
+    static int render(const QVector<Job>& jobs, const QSize& size, int worker = 0, int workers = 1);
+    // Запуск workers копий текущей программы с теми же аргументами и номером
+    // исполнителя; возвращает число завершившихся с ошибкой
+    static int runWorkers(const QStringList& arguments, int workers);
+
+    // Параметр командной строки с номером исполнителя: "k/n"
+    static const char* const WorkerOption;
+
+private:
+    static bool parseJob(const QString& line, Job& job);
+};
+
+#endif // BATCHRENDERER_H
@@ -0,0 +1,83 @@
+#include "ColumnGraph.h"
+#include <algorithm>
+#include <cmath>
+
+ColumnGraph::ColumnGraph(QCPAxis* keyAxis, QCPAxis* valueAxis, std::shared_ptr<const ColumnSeries> series)
+    : QCPGraph(keyAxis, valueAxis), m_series(std::move(series))
+{
+}
+
+QCPRange ColumnGraph::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    return m_series->keyRange(foundRange, inSignDomain);
+}
+
+QCPRange ColumnGraph::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    return m_series->valueRange(foundRange, inSignDomain, inKeyRange);
+}
+
+void ColumnGraph::draw(QCPPainter* painter)
+{
+    if (mKeyAxis)
+        updateView();
+    QCPGraph::draw(painter);
+}
+
+void ColumnGraph::updateView()
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    const QCPRange range = keyAxis->range();
+    const double lowerPixel = keyAxis->coordToPixel(range.lower);
+    const double upperPixel = keyAxis->coordToPixel(range.upper);
+    const int pixels = std::max(1, int(std::abs(upperPixel - lowerPixel)));
+    const ColumnSeries& series = *m_series;
+    if (m_viewValid && range == m_viewRange && pixels == m_viewPixels && series.revision() == m_viewRevision)
+        return;
+    m_viewValid = true;
+    m_viewRange = range;
+    m_viewPixels = pixels;
+    m_viewRevision = series.revision();
+
+    // Соседние с окном точки нужны, чтобы линия доходила до краёв
+    const int from = series.findBegin(range.lower);
+    const int to = series.findEnd(range.upper);
+
+    QVector<QCPGraphData> view;
+    if (to - from <= PointsPerPixel * pixels)
+    {
+        // Точек на пиксель немного: копируем как есть, дальше прореживает QCPGraph
+        view.resize(to - from);
+        for (int i = from; i < to; ++i)
+            view[i - from] = series.at(i);
+    }
+    else
+    {
+        // Столбец — две точки: минимум на первом ключе, максимум на последнем.
+        // В пределах пикселя порядок не важен, вертикальный размах сохраняется.
+        // Граница столбца — ключ его края; для логарифмической оси тоже
+        const QVector<double>& keys = series.keys();
+        const double step = upperPixel > lowerPixel ? 1.0 : -1.0;
+        view.reserve(2 * pixels + 2);
+        int begin = from;
+        for (int column = 1; column <= pixels + 1 && begin < to; ++column)
+        {
+            const int end = column > pixels ? to
+                          : std::min(to, std::max(begin, series.findEnd(keyAxis->pixelToCoord(lowerPixel + column * step), false)));
+            if (end == begin)
+                continue;
+            bool found = false;
+            const QCPRange values = series.valueRange(begin, end, found);
+            // Столбец без конечных значений даёт точку NaN — разрыв линии
+            if (found)
+            {
+                view.append(QCPGraphData(keys[begin], values.lower));
+                view.append(QCPGraphData(keys[end - 1], values.upper));
+            }
+            else
+                view.append(QCPGraphData(keys[begin], qQNaN()));
+            begin = end;
+        }
+    }
+    mDataContainer->set(view, true);
+}
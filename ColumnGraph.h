@@ -0,0 +1,41 @@
+#ifndef COLUMNGRAPH_H
+#define COLUMNGRAPH_H
+
+#include "qcustomplot.h"
+#include "ColumnSeries.h"
+#include <memory>
+
+// График ряда ColumnSeries. Как MappedGraph, перед отрисовкой кладёт в
+// контейнер графика только видимый участок: сами точки, если их на пиксель
+// немного, иначе по две точки (min и max) на столбец пикселей. Границы
+// столбцов ищутся по массиву ключей, min/max — свёрткой по массиву значений.
+// После изменения ряда достаточно перерисовки: график сверяет revision()
+class ColumnGraph : public QCPGraph
+{
+    Q_OBJECT
+
+public:
+    ColumnGraph(QCPAxis* keyAxis, QCPAxis* valueAxis, std::shared_ptr<const ColumnSeries> series);
+
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+
+private:
+    void updateView();
+
+    // Больше точек на пиксель — сводим столбцы к min/max
+    static const int PointsPerPixel = 4;
+
+    std::shared_ptr<const ColumnSeries> m_series;
+    // Для какого диапазона, ширины в пикселях и версии ряда собран контейнер
+    QCPRange m_viewRange;
+    int m_viewPixels = 0;
+    quint64 m_viewRevision = 0;
+    bool m_viewValid = false;
+};
+
+#endif // COLUMNGRAPH_H
@@ -0,0 +1,202 @@
+#include "ColumnSeries.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+void ColumnSeries::set(const QVector<double>& keys, const QVector<double>& values, bool alreadySorted)
+{
+    m_keys.clear();
+    m_values.clear();
+    add(keys, values, alreadySorted);
+}
+
+void ColumnSeries::add(const QVector<double>& keys, const QVector<double>& values, bool alreadySorted)
+{
+    const int n = std::min(keys.size(), values.size());
+    const int oldSize = m_keys.size();
+    m_keys.reserve(oldSize + n);
+    m_values.reserve(oldSize + n);
+    for (int i = 0; i < n; ++i)
+    {
+        if (std::isnan(keys[i]))
+            continue;
+        m_keys.append(keys[i]);
+        m_values.append(values[i]);
+    }
+    sortFrom(oldSize, alreadySorted);
+    ++m_revision;
+}
+
+void ColumnSeries::add(double key, double value)
+{
+    if (std::isnan(key))
+        return;
+    // Равные ключи остаются в порядке добавления
+    const int index = upperBound(key);
+    m_keys.insert(index, key);
+    m_values.insert(index, value);
+    ++m_revision;
+}
+
+void ColumnSeries::removeBefore(double key)
+{
+    const int count = lowerBound(key);
+    m_keys.remove(0, count);
+    m_values.remove(0, count);
+    ++m_revision;
+}
+
+void ColumnSeries::removeAfter(double key)
+{
+    const int index = upperBound(key);
+    m_keys.resize(index);
+    m_values.resize(index);
+    ++m_revision;
+}
+
+void ColumnSeries::clear()
+{
+    m_keys.clear();
+    m_values.clear();
+    ++m_revision;
+}
+
+int ColumnSeries::findBegin(double key, bool expandedRange) const
+{
+    const int index = lowerBound(key);
+    return expandedRange && index > 0 ? index - 1 : index;
+}
+
+int ColumnSeries::findEnd(double key, bool expandedRange) const
+{
+    const int index = upperBound(key);
+    return expandedRange && index < size() ? index + 1 : index;
+}
+
+QCPRange ColumnSeries::keyRange(bool& foundRange, QCP::SignDomain signDomain) const
+{
+    // Ключи упорядочены: граница знака ищется двоичным поиском
+    int first = 0;
+    int last = size();
+    if (signDomain == QCP::sdPositive)
+        first = upperBound(0.0);
+    else if (signDomain == QCP::sdNegative)
+        last = lowerBound(0.0);
+
+    foundRange = first < last;
+    return foundRange ? QCPRange(m_keys[first], m_keys[last - 1]) : QCPRange();
+}
+
+QCPRange ColumnSeries::valueRange(bool& foundRange, QCP::SignDomain signDomain, const QCPRange& inKeyRange) const
+{
+    if (inKeyRange == QCPRange())
+        return valueRange(0, size(), foundRange, signDomain);
+    return valueRange(lowerBound(inKeyRange.lower), upperBound(inKeyRange.upper), foundRange, signDomain);
+}
+
+QCPRange ColumnSeries::valueRange(int from, int to, bool& foundRange, QCP::SignDomain signDomain) const
+{
+    // Точка учитывается, если lowLimit < value < highLimit: строгие сравнения
+    // отсекают и NaN, и бесконечности, как в QCPDataContainer::valueRange
+    const double infinity = std::numeric_limits<double>::infinity();
+    const double lowLimit = signDomain == QCP::sdPositive ? 0.0 : -infinity;
+    const double highLimit = signDomain == QCP::sdNegative ? 0.0 : infinity;
+
+    // Свёртка без ветвлений в несколько независимых полос, чтобы компилятор
+    // раскладывал её по векторным регистрам
+    const int Lanes = 8;
+    double lower[Lanes];
+    double upper[Lanes];
+    std::fill(lower, lower + Lanes, infinity);
+    std::fill(upper, upper + Lanes, -infinity);
+
+    from = std::max(from, 0);
+    to = std::min(to, size());
+    const double* values = m_values.constData();
+    int i = from;
+    for (; i + Lanes <= to; i += Lanes)
+    {
+        for (int lane = 0; lane < Lanes; ++lane)
+        {
+            const double value = values[i + lane];
+            const bool inside = (value > lowLimit) & (value < highLimit);
+            lower[lane] = inside & (value < lower[lane]) ? value : lower[lane];
+            upper[lane] = inside & (value > upper[lane]) ? value : upper[lane];
+        }
+    }
+    for (; i < to; ++i)
+    {
+        const double value = values[i];
+        const bool inside = (value > lowLimit) & (value < highLimit);
+        lower[0] = inside & (value < lower[0]) ? value : lower[0];
+        upper[0] = inside & (value > upper[0]) ? value : upper[0];
+    }
+
+    const double minValue = *std::min_element(lower, lower + Lanes);
+    const double maxValue = *std::max_element(upper, upper + Lanes);
+    foundRange = minValue != infinity;
+    return foundRange ? QCPRange(minValue, maxValue) : QCPRange();
+}
+
+int ColumnSeries::lowerBound(double key) const
+{
+    // Двоичный поиск без ветвлений: сдвиг base компилируется в условную
+    // пересылку, и предсказатель переходов не ошибается на каждом шаге
+    const double* keys = m_keys.constData();
+    int count = m_keys.size();
+    if (count == 0)
+        return 0;
+    const double* base = keys;
+    while (count > 1)
+    {
+        const int half = count / 2;
+        base = base[half] < key ? base + half : base;
+        count -= half;
+    }
+    return int(base - keys) + (*base < key);
+}
+
+int ColumnSeries::upperBound(double key) const
+{
+    const double* keys = m_keys.constData();
+    int count = m_keys.size();
+    if (count == 0)
+        return 0;
+    const double* base = keys;
+    while (count > 1)
+    {
+        const int half = count / 2;
+        base = key < base[half] ? base : base + half;
+        count -= half;
+    }
+    return int(base - keys) + !(key < *base);
+}
+
+void ColumnSeries::sortFrom(int from, bool alreadySorted)
+{
+    const int n = m_keys.size();
+    const double* keys = m_keys.constData();
+    const bool tailSorted = alreadySorted || std::is_sorted(keys + from, keys + n);
+    if (from >= n || (tailSorted && (from == 0 || !(keys[from] < keys[from - 1]))))
+        return;
+
+    // Перестановка индексов: хвост сортируется и сливается с прежними точками,
+    // затем оба массива собираются по ней
+    QVector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    auto less = [keys](int a, int b) { return keys[a] < keys[b]; };
+    if (!tailSorted)
+        std::stable_sort(order.begin() + from, order.end(), less);
+    std::inplace_merge(order.begin(), order.begin() + from, order.end(), less);
+
+    QVector<double> sortedKeys(n);
+    QVector<double> sortedValues(n);
+    for (int i = 0; i < n; ++i)
+    {
+        sortedKeys[i] = keys[order[i]];
+        sortedValues[i] = m_values[order[i]];
+    }
+    m_keys.swap(sortedKeys);
+    m_values.swap(sortedValues);
+}
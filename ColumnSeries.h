@@ -0,0 +1,56 @@
+#ifndef COLUMNSERIES_H
+#define COLUMNSERIES_H
+
+#include "qcustomplot.h"
+
+// Ряд отсчётов в памяти, где ключи и значения лежат в отдельных массивах.
+// QCPDataContainer хранит пары {key, value}, поэтому поиск по ключу и
+// min/max по значениям читают оба поля. Здесь двоичный поиск идёт только
+// по ключам, свёртки — только по значениям, и обе проходят по плотным
+// массивам double, которые компилятор векторизует.
+//
+// Интерфейс повторяет ту часть QCPDataContainer, которой пользуется
+// QCPAbstractPlottable1D (findBegin/findEnd, keyRange, valueRange), но
+// вместо итераторов по структурам возвращает индексы. Ключи неубывающие,
+// точки с ключом NaN не добавляются
+class ColumnSeries
+{
+public:
+    int size() const { return m_keys.size(); }
+    bool isEmpty() const { return m_keys.isEmpty(); }
+    const QVector<double>& keys() const { return m_keys; }
+    const QVector<double>& values() const { return m_values; }
+    QCPGraphData at(int index) const { return QCPGraphData(m_keys.at(index), m_values.at(index)); }
+    // Растёт при каждом изменении: по нему графики узнают, что ряд надо перечитать
+    quint64 revision() const { return m_revision; }
+
+    // Из массивов разной длины берётся общая часть
+    void set(const QVector<double>& keys, const QVector<double>& values, bool alreadySorted = false);
+    void add(const QVector<double>& keys, const QVector<double>& values, bool alreadySorted = false);
+    void add(double key, double value);
+    void removeBefore(double key);
+    void removeAfter(double key);
+    void clear();
+
+    // Как у QCPDataContainer, только индексы: первая точка с ключом не меньше
+    // key (с expandedRange — ещё одна слева) и точка за последней с ключом
+    // не больше key (с expandedRange — ещё одна справа)
+    int findBegin(double key, bool expandedRange = true) const;
+    int findEnd(double key, bool expandedRange = true) const;
+    QCPRange keyRange(bool& foundRange, QCP::SignDomain signDomain = QCP::sdBoth) const;
+    QCPRange valueRange(bool& foundRange, QCP::SignDomain signDomain = QCP::sdBoth,
+                        const QCPRange& inKeyRange = QCPRange()) const;
+    // Диапазон значений точек from..to-1. NaN и бесконечности не учитываются
+    QCPRange valueRange(int from, int to, bool& foundRange, QCP::SignDomain signDomain = QCP::sdBoth) const;
+
+private:
+    int lowerBound(double key) const;
+    int upperBound(double key) const;
+    void sortFrom(int from, bool alreadySorted);
+
+    QVector<double> m_keys;
+    QVector<double> m_values;
+    quint64 m_revision = 0;
+};
+
+#endif // COLUMNSERIES_H
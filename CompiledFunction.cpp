@@ -0,0 +1,380 @@
+#include "CompiledFunction.h"
+#include "VectorMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CompiledFunction::CompiledFunction(const ExprNode& root) {
+    compile(root, 0);
+}
+
+// Код поддерева пишет результат в регистр reg и использует регистры выше reg
+// как временные, поэтому число регистров равно глубине дерева
+int CompiledFunction::compile(const ExprNode& node, int reg) {
+    registerCount = std::max(registerCount, reg + 1);
+
+    switch (node.type) {
+    case ExprNode::Number:
+        emit(LoadConst, reg, 0, 0, node.value, node.coefficient);
+        return reg;
+    case ExprNode::Variable:
+        emit(LoadX, reg);
+        return reg;
+    case ExprNode::Negate:
+        compile(*node.left, reg);
+        emit(Negate, reg, reg);
+        return reg;
+    case ExprNode::Add:
+    case ExprNode::Sub:
+    case ExprNode::Mul:
+    case ExprNode::Div:
+    case ExprNode::Pow: {
+        if (compileImmediate(node, reg)) {
+            return reg;
+        }
+        compile(*node.left, reg);
+        compile(*node.right, reg + 1);
+        OpCode op = node.type == ExprNode::Add ? Add
+                  : node.type == ExprNode::Sub ? Sub
+                  : node.type == ExprNode::Mul ? Mul
+                  : node.type == ExprNode::Div ? Div : Pow;
+        emit(op, reg, reg, reg + 1);
+        return reg;
+    }
+    case ExprNode::Call:
+        break;
+    }
+
+    compile(*node.left, reg);
+    switch (node.func) {
+    case ExprNode::Sin: emit(Sin, reg, reg); break;
+    case ExprNode::Cos: emit(Cos, reg, reg); break;
+    case ExprNode::Tan: emit(Tan, reg, reg); break;
+    case ExprNode::Cot: emit(Cot, reg, reg); break;
+    case ExprNode::Exp: emit(Exp, reg, reg); break;
+    case ExprNode::Ln: emit(Ln, reg, reg); break;
+    case ExprNode::Sqrt: emit(Sqrt, reg, reg); break;
+    case ExprNode::Abs: emit(Abs, reg, reg); break;
+    case ExprNode::Log:
+        compile(*node.right, reg + 1);
+        emit(Log, reg, reg, reg + 1);
+        break;
+    }
+    return reg;
+}
+
+// Бинарная операция с числовым операндом: вычисляем только зависящую от x
+// часть, константа уходит в imm
+bool CompiledFunction::compileImmediate(const ExprNode& node, int reg) {
+    const ExprNode& l = *node.left;
+    const ExprNode& r = *node.right;
+
+    if (r.type == ExprNode::Number) {
+        compile(l, reg);
+        OpCode op = node.type == ExprNode::Add ? AddC
+                  : node.type == ExprNode::Sub ? SubC
+                  : node.type == ExprNode::Mul ? MulC
+                  : node.type == ExprNode::Div ? DivC : PowC;
+        emit(op, reg, reg, 0, r.value, r.coefficient);
+        return true;
+    }
+
+    if (l.type != ExprNode::Number) {
+        return false;
+    }
+
+    compile(r, reg);
+    if (node.type == ExprNode::Pow && l.value == M_E && !l.coefficient) {
+        // e^u — векторная экспонента
+        emit(Exp, reg, reg);
+        return true;
+    }
+    OpCode op = node.type == ExprNode::Add ? AddC
+              : node.type == ExprNode::Sub ? RSubC
+              : node.type == ExprNode::Mul ? MulC
+              : node.type == ExprNode::Div ? RDivC : RPowC;
+    emit(op, reg, reg, 0, l.value, l.coefficient);
+    return true;
+}
+
+void CompiledFunction::emit(OpCode op, int dst, int a, int b, double imm, bool coefficient) {
+    program.append({op, dst, a, b, imm, coefficient});
+}
+
+// Одно значение — отдельным проходом с регистром на число, без блоков.
+// Трансцендентные функции здесь из скалярного libm, поэтому с пакетным
+// вычислением результат может разойтись в последнем разряде
+double CompiledFunction::evaluate(double x) const {
+    thread_local QVector<double> regs;
+    regs.resize(registerCount);
+    double* r = regs.data();
+    for (const Instruction& ins : program) {
+        const double a = r[ins.a];
+        const double b = r[ins.b];
+        double d = 0;
+
+        switch (ins.op) {
+        case LoadX: d = x; break;
+        case LoadConst: d = ins.imm; break;
+        case Negate: d = -a; break;
+        case Add: d = a + b; break;
+        case Sub: d = a - b; break;
+        case Mul: d = a * b; break;
+        case Div: d = a / b; break;
+        case Pow: d = std::pow(a, b); break;
+        case AddC: d = a + ins.imm; break;
+        case SubC: d = a - ins.imm; break;
+        case RSubC: d = ins.imm - a; break;
+        case MulC: d = a * ins.imm; break;
+        case DivC: d = a / ins.imm; break;
+        case RDivC: d = ins.imm / a; break;
+        case RPowC: d = std::pow(ins.imm, a); break;
+        case PowC:
+            // Те же частные случаи, что и в run(): совпадение с пакетным вычислением
+            d = ins.imm == 2.0 ? a * a
+              : ins.imm == 3.0 ? a * a * a
+              : ins.imm == -1.0 ? 1.0 / a : std::pow(a, ins.imm);
+            break;
+        case Sin: d = std::sin(a); break;
+        case Cos: d = std::cos(a); break;
+        case Tan: d = std::tan(a); break;
+        case Cot: {
+            const double t = std::tan(a);
+            d = t != 0 ? 1.0 / t : std::numeric_limits<double>::quiet_NaN();
+            break;
+        }
+        case Exp: d = std::exp(a); break;
+        case Ln: d = std::log(a); break;
+        case Log: d = std::log(a) / std::log(b); break;
+        case Sqrt: d = std::sqrt(a); break;
+        case Abs: d = std::abs(a); break;
+        }
+        r[ins.dst] = d;
+    }
+    return r[0];
+}
+
+void CompiledFunction::evaluate(const double* xs, double* ys, int n) const {
+    // Регистры свои у каждого потока и переиспользуются между вызовами:
+    // выборка вызывает evaluate на каждый отрезок, выделять блоки заново дорого
+    thread_local QVector<double> regs;
+    regs.resize(registerCount * BlockSize);
+    for (int start = 0; start < n; start += BlockSize) {
+        run(xs + start, ys + start, std::min(BlockSize, n - start), regs.data());
+    }
+}
+
+void CompiledFunction::run(const double* xs, double* ys, int n, double* regs) const {
+    for (const Instruction& ins : program) {
+        double* d = regs + ins.dst * BlockSize;
+        double* a = regs + ins.a * BlockSize;
+        double* b = regs + ins.b * BlockSize;
+
+        switch (ins.op) {
+        case LoadX:
+            std::copy(xs, xs + n, d);
+            break;
+        case LoadConst:
+            std::fill(d, d + n, ins.imm);
+            break;
+        case Negate:
+            for (int i = 0; i < n; ++i) d[i] = -a[i];
+            break;
+        case Add:
+            for (int i = 0; i < n; ++i) d[i] = a[i] + b[i];
+            break;
+        case Sub:
+            for (int i = 0; i < n; ++i) d[i] = a[i] - b[i];
+            break;
+        case Mul:
+            for (int i = 0; i < n; ++i) d[i] = a[i] * b[i];
+            break;
+        case Div:
+            for (int i = 0; i < n; ++i) d[i] = a[i] / b[i];
+            break;
+        case Pow:
+            for (int i = 0; i < n; ++i) d[i] = std::pow(a[i], b[i]);
+            break;
+        case AddC:
+            for (int i = 0; i < n; ++i) d[i] = a[i] + ins.imm;
+            break;
+        case SubC:
+            for (int i = 0; i < n; ++i) d[i] = a[i] - ins.imm;
+            break;
+        case RSubC:
+            for (int i = 0; i < n; ++i) d[i] = ins.imm - a[i];
+            break;
+        case MulC:
+            for (int i = 0; i < n; ++i) d[i] = a[i] * ins.imm;
+            break;
+        case DivC:
+            for (int i = 0; i < n; ++i) d[i] = a[i] / ins.imm;
+            break;
+        case RDivC:
+            for (int i = 0; i < n; ++i) d[i] = ins.imm / a[i];
+            break;
+        case RPowC:
+            // std::pow, а не exp(u * ln c): целые степени точны (2^3 == 8)
+            for (int i = 0; i < n; ++i) d[i] = std::pow(ins.imm, a[i]);
+            break;
+        case PowC:
+            // Частые целые степени без std::pow
+            if (ins.imm == 2.0) {
+                for (int i = 0; i < n; ++i) d[i] = a[i] * a[i];
+            } else if (ins.imm == 3.0) {
+                for (int i = 0; i < n; ++i) d[i] = a[i] * a[i] * a[i];
+            } else if (ins.imm == -1.0) {
+                for (int i = 0; i < n; ++i) d[i] = 1.0 / a[i];
+            } else {
+                for (int i = 0; i < n; ++i) d[i] = std::pow(a[i], ins.imm);
+            }
+            break;
+        case Sin:
+            VectorMath::sin(a, d, n);
+            break;
+        case Cos:
+            VectorMath::cos(a, d, n);
+            break;
+        case Tan:
+            VectorMath::tan(a, d, n);
+            break;
+        case Cot:
+            VectorMath::tan(a, d, n);
+            // В полюсе — NaN: график рвётся, а не идёт через ноль
+            for (int i = 0; i < n; ++i) d[i] = d[i] != 0 ? 1.0 / d[i] : std::numeric_limits<double>::quiet_NaN();
+            break;
+        case Exp:
+            VectorMath::exp(a, d, n);
+            break;
+        case Ln:
+            VectorMath::log(a, d, n);
+            break;
+        case Log:
+            // Регистр основания временный, его можно перезаписать
+            VectorMath::log(a, d, n);
+            VectorMath::log(b, b, n);
+            for (int i = 0; i < n; ++i) d[i] /= b[i];
+            break;
+        case Sqrt:
+            for (int i = 0; i < n; ++i) d[i] = std::sqrt(a[i]);
+            break;
+        case Abs:
+            for (int i = 0; i < n; ++i) d[i] = std::abs(a[i]);
+            break;
+        }
+    }
+
+    std::copy(regs, regs + n, ys);
+}
+
+void CompiledFunction::setCoefficients(const QVector<double>& coeffs) {
+    int k = 0;
+    for (Instruction& ins : program) {
+        if (ins.coefficient && k < coeffs.size()) {
+            ins.imm = coeffs[k++];
+        }
+    }
+}
+
+QVector<double> CompiledFunction::getCoefficients() const {
+    QVector<double> coeffs;
+    for (const Instruction& ins : program) {
+        if (ins.coefficient) {
+            coeffs.append(ins.imm);
+        }
+    }
+    return coeffs;
+}
+
+QString CompiledFunction::getName() const {
+    return "Expression";
+}
+
+int CompiledFunction::capabilities() const {
+    int caps = 0;
+    for (const Instruction& ins : program) {
+        switch (ins.op) {
+        case Div:
+        case RDivC:
+        case Tan:
+        case Cot:
+            caps |= HasAsymptotes;
+            break;
+        case PowC:
+            if (ins.imm < 0) {
+                caps |= HasAsymptotes;
+            }
+            if (ins.imm != std::floor(ins.imm)) {
+                caps |= BoundedDomain;
+            }
+            break;
+        case RPowC:
+            // 0^u при u < 0 — бесконечность, отрицательное основание — только целые u
+            if (ins.imm <= 0) {
+                caps |= HasAsymptotes | BoundedDomain;
+            }
+            break;
+        case Pow:
+            caps |= HasAsymptotes | BoundedDomain;
+            break;
+        case Ln:
+        case Log:
+            caps |= HasAsymptotes | BoundedDomain;
+            break;
+        case Sqrt:
+            caps |= BoundedDomain;
+            break;
+        default:
+            break;
+        }
+    }
+    return caps;
+}
+
+Interval CompiledFunction::bounds(double lower, double upper) const {
+    // Вызывается на каждый блок узлов: регистры переиспользуются, а не
+    // выделяются заново. Каждый регистр пишется раньше, чем читается
+    thread_local QVector<Interval> regs;
+    regs.resize(registerCount);
+    for (const Instruction& ins : program) {
+        const Interval& a = regs[ins.a];
+        const Interval& b = regs[ins.b];
+        Interval r;
+
+        switch (ins.op) {
+        case LoadX: r = Interval(lower, upper); break;
+        case LoadConst: r = Interval(ins.imm); break;
+        case Negate: r = -a; break;
+        case Add: r = a + b; break;
+        case Sub: r = a - b; break;
+        case Mul: r = a * b; break;
+        case Div: r = a / b; break;
+        case Pow:
+            // Постоянный показатель считается точно, иначе a^b = exp(b * ln a) при a > 0
+            r = b.lower == b.upper ? Interval::pow(a, b.lower) : Interval::exp(b * Interval::log(a));
+            break;
+        case AddC: r = a + ins.imm; break;
+        case SubC: r = a - ins.imm; break;
+        case RSubC: r = ins.imm - a; break;
+        case MulC: r = a * ins.imm; break;
+        case DivC: r = a / ins.imm; break;
+        case RDivC: r = ins.imm / a; break;
+        case RPowC: r = Interval::pow(ins.imm, a); break;
+        case PowC: r = Interval::pow(a, ins.imm); break;
+        case Sin: r = Interval::sin(a); break;
+        case Cos: r = Interval::cos(a); break;
+        case Tan: r = Interval::tan(a); break;
+        case Cot: r = Interval::cot(a); break;
+        case Exp: r = Interval::exp(a); break;
+        case Ln: r = Interval::log(a); break;
+        case Log: r = Interval::log(a) / Interval::log(b); break;
+        case Sqrt: r = Interval::sqrt(a); break;
+        case Abs: r = Interval::abs(a); break;
+        }
+        if (!r.isValid()) {
+            return Interval::invalid();
+        }
+        regs[ins.dst] = r;
+    }
+    return regs[0];
+}
@@ -0,0 +1,61 @@
+#ifndef COMPILEDFUNCTION_H
+#define COMPILEDFUNCTION_H
+
+#include "Function.h"
+#include "Expression.h"
+
+// Произвольное выражение, скомпилированное в линейный регистровый байт-код.
+// Каждая инструкция обрабатывает сразу блок значений x, поэтому пакетное
+// вычисление — один проход по программе на блок без рекурсии и виртуальных вызовов.
+class CompiledFunction : public Function {
+public:
+    explicit CompiledFunction(const ExprNode& root);
+
+    double evaluate(double x) const override;
+    void evaluate(const double* xs, double* ys, int n) const override;
+    // Коэффициенты — числа из входной строки в порядке их появления в
+    // программе. Константы, полученные упрощением (1/c, 1/ln b, свёрнутые
+    // подвыражения), в них не входят
+    void setCoefficients(const QVector<double>& coeffs) override;
+    QVector<double> getCoefficients() const override;
+    QString getName() const override;
+    Kind kind() const override { return Expression; }
+    // Оценка по составу программы: деление, tan/cot и логарифмы могут дать
+    // асимптоты, логарифмы, sqrt и степени — сузить область определения
+    int capabilities() const override;
+    // Та же программа над интервалами вместо блока чисел
+    Interval bounds(double lower, double upper) const override;
+
+private:
+    // Операции с суффиксом C берут второй операнд из imm, а не из регистра:
+    // константа не размножается по блоку на каждом проходе
+    enum OpCode {
+        LoadX, LoadConst, Negate, Add, Sub, Mul, Div, Pow,
+        AddC, SubC, RSubC, MulC, DivC, RDivC, PowC, RPowC,
+        Sin, Cos, Tan, Cot, Exp, Ln, Log, Sqrt, Abs
+    };
+
+    // dst = op(a, b); a, b, dst — номера регистров, imm — константа,
+    // coefficient — imm доступна через get/setCoefficients
+    struct Instruction {
+        OpCode op;
+        int dst;
+        int a;
+        int b;
+        double imm;
+        bool coefficient;
+    };
+
+    // Размер блока: регистры помещаются в кэш L1 даже для длинных программ
+    static constexpr int BlockSize = 256;
+
+    int compile(const ExprNode& node, int reg);
+    bool compileImmediate(const ExprNode& node, int reg);
+    void emit(OpCode op, int dst, int a = 0, int b = 0, double imm = 0.0, bool coefficient = false);
+    void run(const double* xs, double* ys, int n, double* regs) const;
+
+    QVector<Instruction> program;
+    int registerCount = 1;
+};
+
+#endif // COMPILEDFUNCTION_H
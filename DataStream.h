@@ -0,0 +1,99 @@
+#ifndef DATASTREAM_H
+#define DATASTREAM_H
+
+#include "qcustomplot.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Кольцевой буфер без блокировок для одного писателя и одного читателя.
+// push вызывается только из потока-производителя, pop и size — только
+// из потока-потребителя. Ёмкость округляется вверх до степени двойки
+template <typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(int capacity)
+    {
+        size_t size = 1;
+        while (size < static_cast<size_t>(std::max(capacity, 1)))
+            size <<= 1;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    // false — буфер полон
+    bool push(const T& value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+            return false;
+        m_buffer[head & m_mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Забирает до max элементов в out, возвращает их число
+    int pop(T* out, int max)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t count = std::min(m_head.load(std::memory_order_acquire) - tail,
+                                      static_cast<size_t>(max));
+        for (size_t i = 0; i < count; ++i)
+            out[i] = m_buffer[(tail + i) & m_mask];
+        m_tail.store(tail + count, std::memory_order_release);
+        return static_cast<int>(count);
+    }
+
+    int size() const
+    {
+        return static_cast<int>(m_head.load(std::memory_order_acquire) -
+                                m_tail.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::vector<T> m_buffer;
+    size_t m_mask;
+    // Счётчики растут неограниченно, индекс — по маске. Писатель и читатель
+    // меняют разные строки кэша
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+// Живой ряд отсчётов (key, value), например телеметрия. Производитель
+// добавляет отсчёты из своего потока, GraphicWidget забирает их в потоке GUI
+// с частотой кадров. Ключи ожидаются неубывающими (время)
+class DataStream
+{
+public:
+    explicit DataStream(int capacity = DefaultCapacity) : m_ring(capacity) {}
+
+    // Поток производителя. false — буфер полон (GUI не успевает), отсчёт отброшен
+    bool push(double key, double value)
+    {
+        if (m_ring.push(QCPGraphData(key, value)))
+            return true;
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Поток GUI: все накопленные отсчёты в out
+    int drain(QVector<QCPGraphData>& out)
+    {
+        out.resize(m_ring.size());
+        const int count = m_ring.pop(out.data(), out.size());
+        out.resize(count);
+        return count;
+    }
+
+    quint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Запас примерно на секунду при 60 кГц
+    static const int DefaultCapacity = 1 << 16;
+
+private:
+    RingBuffer<QCPGraphData> m_ring;
+    std::atomic<quint64> m_dropped{0};
+};
+
+#endif // DATASTREAM_H
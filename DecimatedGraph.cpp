@@ -0,0 +1,211 @@
+#include "DecimatedGraph.h"
+#include <algorithm>
+#include <cmath>
+
+DecimatedGraph::DecimatedGraph(QCPAxis* keyAxis, QCPAxis* valueAxis)
+    : QCPGraph(keyAxis, valueAxis)
+{
+}
+
+void DecimatedGraph::invalidateLevels()
+{
+    m_pyramid = Pyramid();
+}
+
+void DecimatedGraph::removeBefore(double key)
+{
+    QSharedPointer<QCPGraphDataContainer> container = mDataContainer;
+    const int removed = int(container->findBegin(key, false) - container->constBegin());
+    container->removeBefore(key);
+    if (removed == 0 || m_pyramid.size == 0 || m_pyramid.container.toStrongRef() != container)
+        return;
+    // Удалены и точки, дописанные после построения, — проще перестроить
+    if (removed >= m_pyramid.size || m_pyramid.offset + removed > MaxOffset)
+    {
+        invalidateLevels();
+        return;
+    }
+
+    // Корзины, целиком ушедшие вместе с точками, отбрасываются. Начало
+    // вектора сдвигается, только когда ушла хотя бы половина корзин уровня:
+    // в среднем удаление стоит O(1) на корзину
+    m_pyramid.offset += removed;
+    m_pyramid.size -= removed;
+    m_pyramid.first = *container->constBegin();
+    for (int level = 0; level < m_pyramid.levels.size(); ++level)
+    {
+        Level& current = m_pyramid.levels[level];
+        const int gone = std::min(m_pyramid.offset / (BucketPoints << level) - current.start, int(current.buckets.size()));
+        if (gone > 0 && 2 * gone >= current.buckets.size())
+        {
+            current.buckets.remove(0, gone);
+            current.start += gone;
+        }
+    }
+}
+
+void DecimatedGraph::getOptimizedLineData(QVector<QCPGraphData>* lineData,
+                                          const QCPGraphDataContainer::const_iterator& begin,
+                                          const QCPGraphDataContainer::const_iterator& end) const
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    if (!lineData || !keyAxis || !mValueAxis || begin == end ||
+        !mAdaptiveSampling || mDataContainer->size() < MinPoints)
+    {
+        QCPGraph::getOptimizedLineData(lineData, begin, end);
+        return;
+    }
+
+    updateLevels();
+
+    // Самый грубый уровень, у которого корзина не шире пикселя (при
+    // равномерных ключах). Если точек на пиксель мало, пирамида не нужна
+    const int count = int(end - begin);
+    const double pixels = std::max(1.0, std::abs(keyAxis->coordToPixel(begin->key) -
+                                                 keyAxis->coordToPixel((end - 1)->key)));
+    const double pointsPerPixel = count / pixels;
+    int level = -1;
+    while (level + 1 < m_pyramid.levels.size() && double(qint64(BucketPoints) << (level + 1)) <= pointsPerPixel)
+        ++level;
+    if (level < 0)
+    {
+        QCPGraph::getOptimizedLineData(lineData, begin, end);
+        return;
+    }
+
+    const QCPGraphData* data = &*mDataContainer->constBegin();
+    lineData->clear();
+    lineData->reserve(int(3 * pixels) + 4 * BucketPoints * (level + 1));
+    emitRange(data, int(&*begin - data), int(&*begin - data) + count, level, lineData);
+}
+
+void DecimatedGraph::updateLevels() const
+{
+    QSharedPointer<QCPGraphDataContainer> container = mDataContainer;
+    const int size = container->size();
+    const QCPGraphData* data = &*container->constBegin();
+
+    // Прежние корзины годятся, только если старые точки остались на месте,
+    // а новые дописаны в конец
+    const bool appended = m_pyramid.size > 0 && size >= m_pyramid.size && m_pyramid.container.toStrongRef() == container &&
+                          samePoint(data[0], m_pyramid.first) && samePoint(data[m_pyramid.size - 1], m_pyramid.last);
+    if (!appended)
+    {
+        m_pyramid.levels.clear();
+        m_pyramid.offset = 0;
+    }
+
+    // Нижний уровень — по точкам, каждый следующий — по парам корзин
+    // предыдущего. Неполные корзины в конце не хранятся, в начале (после
+    // удаления точек) — не строятся
+    const int end = m_pyramid.offset + size;
+    if (m_pyramid.levels.isEmpty())
+        m_pyramid.levels.append(Level());
+    // Уровни, уже построенные раньше, досчитываются все, даже если нижний
+    // после удаления точек обеднел
+    for (int level = 0; level < m_pyramid.levels.size() || m_pyramid.levels[level - 1].buckets.size() >= 2; ++level)
+    {
+        if (level == m_pyramid.levels.size())
+            m_pyramid.levels.append(Level());
+        const int span = BucketPoints << level;
+        Level& current = m_pyramid.levels[level];
+        const int firstWhole = (m_pyramid.offset + span - 1) / span;
+        if (current.start + current.buckets.size() < firstWhole)
+        {
+            current.buckets.clear();
+            current.start = firstWhole;
+        }
+        if (level == 0)
+        {
+            for (int b = current.start + current.buckets.size(); b < end / BucketPoints; ++b)
+            {
+                Bucket bucket = {-1, -1, -1};
+                for (int i = b * BucketPoints; i < (b + 1) * BucketPoints; ++i)
+                {
+                    const double value = data[i - m_pyramid.offset].value;
+                    if (std::isnan(value))
+                    {
+                        if (bucket.nan < 0)
+                            bucket.nan = i;
+                        continue;
+                    }
+                    if (bucket.min < 0 || value < data[bucket.min - m_pyramid.offset].value)
+                        bucket.min = i;
+                    if (bucket.max < 0 || value > data[bucket.max - m_pyramid.offset].value)
+                        bucket.max = i;
+                }
+                current.buckets.append(bucket);
+            }
+        }
+        else
+        {
+            const Level& lower = m_pyramid.levels[level - 1];
+            for (int b = current.start + current.buckets.size(); b < (lower.start + lower.buckets.size()) / 2; ++b)
+                current.buckets.append(merge(lower.buckets[2 * b - lower.start], lower.buckets[2 * b + 1 - lower.start],
+                                             data, m_pyramid.offset));
+        }
+    }
+
+    m_pyramid.container = container;
+    m_pyramid.size = size;
+    m_pyramid.first = data[0];
+    m_pyramid.last = data[size - 1];
+}
+
+void DecimatedGraph::emitRange(const QCPGraphData* data, int from, int to, int level,
+                               QVector<QCPGraphData>* out) const
+{
+    if (from >= to)
+        return;
+    if (level < 0)
+    {
+        for (int i = from; i < to; ++i)
+            out->append(data[i]);
+        return;
+    }
+
+    // Целые корзины уровня берутся из пирамиды, неполные края — с более
+    // мелких уровней: на каждом уровне не больше двух корзин с каждого края.
+    // from и to — индексы в контейнере, номера корзин — по индексам пирамиды
+    const int span = BucketPoints << level;
+    const int first = (from + m_pyramid.offset + span - 1) / span;
+    const int last = (to + m_pyramid.offset) / span;
+    if (first >= last)
+    {
+        emitRange(data, from, to, level - 1, out);
+        return;
+    }
+
+    emitRange(data, from, first * span - m_pyramid.offset, level - 1, out);
+    const Level& current = m_pyramid.levels[level];
+    for (int b = first; b < last; ++b)
+    {
+        // Точки корзины в порядке ключей, без повторов
+        const Bucket& bucket = current.buckets[b - current.start];
+        int points[3] = {bucket.min, bucket.max, bucket.nan};
+        std::sort(points, points + 3);
+        for (int k = 0; k < 3; ++k)
+        {
+            if (points[k] >= 0 && (k == 0 || points[k] != points[k - 1]))
+                out->append(data[points[k] - m_pyramid.offset]);
+        }
+    }
+    emitRange(data, last * span - m_pyramid.offset, to, level - 1, out);
+}
+
+DecimatedGraph::Bucket DecimatedGraph::merge(const Bucket& a, const Bucket& b, const QCPGraphData* data, int offset)
+{
+    Bucket result;
+    result.min = a.min < 0 ? b.min
+               : b.min < 0 || data[a.min - offset].value <= data[b.min - offset].value ? a.min : b.min;
+    result.max = a.max < 0 ? b.max
+               : b.max < 0 || data[a.max - offset].value >= data[b.max - offset].value ? a.max : b.max;
+    result.nan = a.nan >= 0 ? a.nan : b.nan;
+    return result;
+}
+
+bool DecimatedGraph::samePoint(const QCPGraphData& a, const QCPGraphData& b)
+{
+    return a.key == b.key &&
+           (a.value == b.value || (std::isnan(a.value) && std::isnan(b.value)));
+}
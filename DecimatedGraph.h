@@ -0,0 +1,77 @@
+#ifndef DECIMATEDGRAPH_H
+#define DECIMATEDGRAPH_H
+
+#include "qcustomplot.h"
+
+// График для больших рядов данных. Вместо просмотра всех видимых точек
+// при каждой перерисовке строит один раз пирамиду min/max: корзина уровня L
+// покрывает BucketPoints * 2^L подряд идущих точек и хранит индексы точек
+// с наименьшим и наибольшим значением (и NaN, чтобы не терять разрывы).
+// Отрисовка берёт уровень, где корзина не шире пикселя, поэтому её время
+// пропорционально числу пикселей, а не точек.
+//
+// Добавление точек в конец контейнера досчитывает только новые корзины,
+// удаление из начала через removeBefore() отбрасывает ушедшие корзины;
+// любая другая замена данных перестраивает пирамиду целиком. После правки
+// точек на месте (data()->begin(), setData с тем же контейнером) нужно
+// вызвать invalidateLevels()
+class DecimatedGraph : public QCPGraph
+{
+    Q_OBJECT
+
+public:
+    explicit DecimatedGraph(QCPAxis* keyAxis, QCPAxis* valueAxis);
+
+    void invalidateLevels();
+    // Удаляет точки с ключом меньше key (как data()->removeBefore), сохраняя пирамиду
+    void removeBefore(double key);
+
+protected:
+    void getOptimizedLineData(QVector<QCPGraphData>* lineData,
+                              const QCPGraphDataContainer::const_iterator& begin,
+                              const QCPGraphDataContainer::const_iterator& end) const override;
+
+protected:
+    // Индексы точек, -1 — таких точек нет. Индекс отсчитывается от первой
+    // точки контейнера на момент построения пирамиды: индекс в контейнере
+    // плюс число удалённых с тех пор из начала точек (offset)
+    struct Bucket {
+        int min;
+        int max;
+        int nan;
+    };
+    // Корзины уровня с номерами start, start + 1, ... Корзина b покрывает
+    // индексы [b * span, (b + 1) * span). Корзины, задевающие удалённые
+    // точки, не читаются: отрисовка берёт только корзины внутри видимых данных
+    struct Level {
+        int start = 0;
+        QVector<Bucket> buckets;
+    };
+    // Пирамида одного контейнера и то, по чему видно, что он не менялся
+    struct Pyramid {
+        QVector<Level> levels;
+        QWeakPointer<QCPGraphDataContainer> container;
+        int size = 0;
+        int offset = 0;
+        QCPGraphData first;
+        QCPGraphData last;
+    };
+
+    // Пирамида строится лениво при отрисовке, поэтому изменяема в const-методах
+    mutable Pyramid m_pyramid;
+
+private:
+    // Точек в корзине нижнего уровня
+    static const int BucketPoints = 16;
+    // Меньшие ряды обходятся обычной адаптивной выборкой QCPGraph
+    static const int MinPoints = 1 << 16;
+    // При таком числе удалённых точек пирамида строится заново, чтобы индексы не переполнились
+    static const int MaxOffset = 1 << 30;
+
+    void updateLevels() const;
+    void emitRange(const QCPGraphData* data, int from, int to, int level, QVector<QCPGraphData>* out) const;
+    static Bucket merge(const Bucket& a, const Bucket& b, const QCPGraphData* data, int offset);
+    static bool samePoint(const QCPGraphData& a, const QCPGraphData& b);
+};
+
+#endif // DECIMATEDGRAPH_H
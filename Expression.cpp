@@ -0,0 +1,408 @@
+#include "Expression.h"
+#include <QtMath>
+#include <cmath>
+#include <limits>
+
+ExprPtr ExprNode::number(double v, bool coefficient) {
+    ExprPtr node(new ExprNode);
+    node->type = Number;
+    node->value = v;
+    node->coefficient = coefficient;
+    return node;
+}
+
+ExprPtr ExprNode::variable() {
+    ExprPtr node(new ExprNode);
+    node->type = Variable;
+    return node;
+}
+
+ExprPtr ExprNode::unary(Type type, ExprPtr arg) {
+    ExprPtr node(new ExprNode);
+    node->type = type;
+    node->left = std::move(arg);
+    return node;
+}
+
+ExprPtr ExprNode::binary(Type type, ExprPtr l, ExprPtr r) {
+    ExprPtr node(new ExprNode);
+    node->type = type;
+    node->left = std::move(l);
+    node->right = std::move(r);
+    return node;
+}
+
+ExprPtr ExprNode::call(Func func, ExprPtr arg, ExprPtr base) {
+    ExprPtr node(new ExprNode);
+    node->type = Call;
+    node->func = func;
+    node->left = std::move(arg);
+    node->right = std::move(base);
+    return node;
+}
+
+bool ExprNode::isConstant() const {
+    if (type == Variable) {
+        return false;
+    }
+    return (!left || left->isConstant()) && (!right || right->isConstant());
+}
+
+double ExprNode::evaluate(double x) const {
+    switch (type) {
+    case Number: return value;
+    case Variable: return x;
+    case Negate: return -left->evaluate(x);
+    case Add: return left->evaluate(x) + right->evaluate(x);
+    case Sub: return left->evaluate(x) - right->evaluate(x);
+    case Mul: return left->evaluate(x) * right->evaluate(x);
+    case Div: return left->evaluate(x) / right->evaluate(x);
+    case Pow: return std::pow(left->evaluate(x), right->evaluate(x));
+    case Call: break;
+    }
+
+    double arg = left->evaluate(x);
+    switch (func) {
+    case Sin: return std::sin(arg);
+    case Cos: return std::cos(arg);
+    case Tan: return std::tan(arg);
+    case Cot: {
+        // В полюсе — NaN, как у TrigonometricFunction
+        double t = std::tan(arg);
+        return t != 0 ? 1.0 / t : std::numeric_limits<double>::quiet_NaN();
+    }
+    case Exp: return std::exp(arg);
+    case Ln: return std::log(arg);
+    case Log: return std::log(arg) / std::log(right->evaluate(x));
+    case Sqrt: return std::sqrt(arg);
+    case Abs: return std::abs(arg);
+    }
+    return 0;
+}
+
+bool ExpressionSimplifier::isNumber(const ExprNode* node, double value) {
+    return node && node->type == ExprNode::Number && node->value == value;
+}
+
+ExprPtr ExpressionSimplifier::simplify(ExprPtr node) {
+    if (node->left) node->left = simplify(std::move(node->left));
+    if (node->right) node->right = simplify(std::move(node->right));
+
+    ExprNode* l = node->left.get();
+    ExprNode* r = node->right.get();
+
+    // Все операнды уже свёрнуты в числа — сворачиваем и сам узел
+    if (node->type != ExprNode::Number && node->type != ExprNode::Variable &&
+        (!l || l->type == ExprNode::Number) && (!r || r->type == ExprNode::Number)) {
+        // Смена знака не делает число новым: -3 остаётся коэффициентом
+        const bool coefficient = node->type == ExprNode::Negate && l->coefficient;
+        return ExprNode::number(node->evaluate(0.0), coefficient);
+    }
+
+    switch (node->type) {
+    case ExprNode::Add:
+        if (isNumber(r, 0.0)) return std::move(node->left);
+        if (isNumber(l, 0.0)) return std::move(node->right);
+        break;
+    case ExprNode::Sub:
+        if (isNumber(r, 0.0)) return std::move(node->left);
+        if (isNumber(l, 0.0)) return simplify(ExprNode::unary(ExprNode::Negate, std::move(node->right)));
+        break;
+    case ExprNode::Mul:
+        // Константу держим слева, чтобы соседние множители сливались
+        if (r->type == ExprNode::Number) {
+            std::swap(node->left, node->right);
+            std::swap(l, r);
+        }
+        if (isNumber(l, 1.0)) return std::move(node->right);
+        if (isNumber(l, -1.0)) return simplify(ExprNode::unary(ExprNode::Negate, std::move(node->right)));
+        if (l->type == ExprNode::Number && r->type == ExprNode::Mul && r->left->type == ExprNode::Number) {
+            l->value *= r->left->value;
+            l->coefficient = false;
+            node->right = std::move(r->right);
+        } else if (l->type == ExprNode::Number && r->type == ExprNode::Negate) {
+            l->value = -l->value;
+            node->right = std::move(r->left);
+        }
+        break;
+    case ExprNode::Div:
+        if (isNumber(r, 1.0)) return std::move(node->left);
+        if (r->type == ExprNode::Number) {
+            return simplify(ExprNode::binary(ExprNode::Mul, ExprNode::number(1.0 / r->value),
+                                             std::move(node->left)));
+        }
+        break;
+    case ExprNode::Pow:
+        if (isNumber(r, 1.0)) return std::move(node->left);
+        if (isNumber(r, 0.0)) return ExprNode::number(1.0);
+        break;
+    case ExprNode::Negate:
+        if (l->type == ExprNode::Negate) return std::move(l->left);
+        if (l->type == ExprNode::Mul && l->left->type == ExprNode::Number) {
+            l->left->value = -l->left->value;
+            return std::move(node->left);
+        }
+        break;
+    case ExprNode::Call:
+        if (node->func == ExprNode::Log) {
+            ExprPtr ln = ExprNode::call(ExprNode::Ln, std::move(node->left));
+            if (r->type == ExprNode::Number) {
+                return simplify(ExprNode::binary(ExprNode::Mul, ExprNode::number(1.0 / std::log(r->value)),
+                                                 std::move(ln)));
+            }
+            return ExprNode::binary(ExprNode::Div, std::move(ln),
+                                    ExprNode::call(ExprNode::Ln, std::move(node->right)));
+        }
+        break;
+    default:
+        break;
+    }
+    return node;
+}
+
+ExprPtr ExpressionReader::read(const QString& input) {
+    QVector<ExprToken> tokens;
+    if (!tokenize(input, tokens)) {
+        return nullptr;
+    }
+
+    ExpressionReader reader(tokens);
+    ExprPtr root = reader.parseExpression();
+    if (!root || reader.peek().type != ExprToken::End) {
+        return nullptr;
+    }
+    return root;
+}
+
+ExpressionReader::ExpressionReader(const QVector<ExprToken>& tokens)
+    : m_tokens(tokens) {}
+
+bool ExpressionReader::tokenize(const QString& input, QVector<ExprToken>& tokens) {
+    static const QString operators = QStringLiteral("+-*/^()|_");
+    const int length = input.length();
+    // Лексем не больше, чем символов, плюс End
+    tokens.reserve(length + 1);
+    int i = 0;
+    while (i < length) {
+        QChar ch = input.at(i);
+        if (ch.isSpace()) {
+            ++i;
+            continue;
+        }
+
+        ExprToken token;
+        if (ch.isDigit() || ch == '.') {
+            // Число: цифры, дробная часть и порядок вида 1e-3
+            int start = i;
+            while (i < length && (input.at(i).isDigit() || input.at(i) == '.')) {
+                ++i;
+            }
+            if (i + 1 < length && (input.at(i) == 'e' || input.at(i) == 'E')) {
+                int j = i + 1;
+                if (input.at(j) == '+' || input.at(j) == '-') {
+                    ++j;
+                }
+                if (j < length && input.at(j).isDigit()) {
+                    i = j;
+                    while (i < length && input.at(i).isDigit()) {
+                        ++i;
+                    }
+                }
+            }
+            bool ok = false;
+            token.type = ExprToken::Number;
+            // Число читается прямо из строки, без копии подстроки
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+            token.value = QStringView(input).mid(start, i - start).toDouble(&ok);
+#else
+            token.value = input.midRef(start, i - start).toDouble(&ok);
+#endif
+            if (!ok) {
+                return false;
+            }
+        } else if (ch.isLetter()) {
+            int start = i;
+            while (i < length && input.at(i).isLetter()) {
+                ++i;
+            }
+            token.type = ExprToken::Identifier;
+            token.text = input.mid(start, i - start).toLower();
+        } else if (operators.contains(ch)) {
+            token.type = ExprToken::Operator;
+            token.op = ch;
+            ++i;
+        } else {
+            return false;
+        }
+        tokens.append(token);
+    }
+
+    tokens.append(ExprToken());
+    return true;
+}
+
+const ExprToken& ExpressionReader::peek() const {
+    return m_tokens[m_pos];
+}
+
+bool ExpressionReader::acceptOperator(QChar op) {
+    const ExprToken& token = peek();
+    if (token.type == ExprToken::Operator && token.op == op) {
+        ++m_pos;
+        return true;
+    }
+    return false;
+}
+
+// Лексема, с которой может начинаться множитель при неявном умножении (2x, 3sin(x), x(x+1))
+bool ExpressionReader::startsFactor(const ExprToken& token) const {
+    return token.type == ExprToken::Identifier ||
+           (token.type == ExprToken::Operator && token.op == '(');
+}
+
+ExprPtr ExpressionReader::parseExpression() {
+    ExprPtr left = parseTerm();
+    while (left) {
+        if (acceptOperator('+')) {
+            ExprPtr right = parseTerm();
+            if (!right) return nullptr;
+            left = ExprNode::binary(ExprNode::Add, std::move(left), std::move(right));
+        } else if (acceptOperator('-')) {
+            ExprPtr right = parseTerm();
+            if (!right) return nullptr;
+            left = ExprNode::binary(ExprNode::Sub, std::move(left), std::move(right));
+        } else {
+            break;
+        }
+    }
+    return left;
+}
+
+ExprPtr ExpressionReader::parseTerm() {
+    ExprPtr left = parseUnary();
+    while (left) {
+        ExprNode::Type type;
+        ExprPtr right;
+        if (acceptOperator('*')) {
+            type = ExprNode::Mul;
+            right = parseUnary();
+        } else if (acceptOperator('/')) {
+            type = ExprNode::Div;
+            right = parseUnary();
+        } else if (startsFactor(peek()) ||
+                   (m_absDepth == 0 && left->type == ExprNode::Number &&
+                    peek().type == ExprToken::Operator && peek().op == '|')) {
+            // Неявное умножение; модуль после числа (2|x|) — только вне других
+            // модулей, иначе '|' после числа считается закрывающей чертой
+            type = ExprNode::Mul;
+            right = parsePower();
+        } else {
+            break;
+        }
+        if (!right) return nullptr;
+        left = ExprNode::binary(type, std::move(left), std::move(right));
+    }
+    return left;
+}
+
+ExprPtr ExpressionReader::parseUnary() {
+    if (acceptOperator('-')) {
+        ExprPtr arg = parseUnary();
+        if (!arg) return nullptr;
+        // Отрицательное число остаётся литералом, чтобы работало -2|x|
+        if (arg->type == ExprNode::Number) {
+            arg->value = -arg->value;
+            return arg;
+        }
+        return ExprNode::unary(ExprNode::Negate, std::move(arg));
+    }
+    if (acceptOperator('+')) {
+        return parseUnary();
+    }
+    return parsePower();
+}
+
+ExprPtr ExpressionReader::parsePower() {
+    ExprPtr base = parsePrimary();
+    if (base && acceptOperator('^')) {
+        ExprPtr exponent = parseUnary();
+        if (!exponent) return nullptr;
+        return ExprNode::binary(ExprNode::Pow, std::move(base), std::move(exponent));
+    }
+    return base;
+}
+
+ExprPtr ExpressionReader::parsePrimary() {
+    const ExprToken token = peek();
+
+    if (token.type == ExprToken::Number) {
+        ++m_pos;
+        return ExprNode::number(token.value, true);
+    }
+
+    if (acceptOperator('(')) {
+        ExprPtr inner = parseExpression();
+        if (!inner || !acceptOperator(')')) return nullptr;
+        return inner;
+    }
+
+    if (acceptOperator('|')) {
+        ++m_absDepth;
+        ExprPtr inner = parseExpression();
+        --m_absDepth;
+        if (!inner || !acceptOperator('|')) return nullptr;
+        return ExprNode::call(ExprNode::Abs, std::move(inner));
+    }
+
+    if (token.type != ExprToken::Identifier) {
+        return nullptr;
+    }
+    ++m_pos;
+
+    const QString& name = token.text;
+    if (name == "x") return ExprNode::variable();
+    if (name == "pi") return ExprNode::number(M_PI);
+    if (name == "e") return ExprNode::number(M_E);
+
+    ExprNode::Func func;
+    ExprPtr base;
+    if (name == "sin") func = ExprNode::Sin;
+    else if (name == "cos") func = ExprNode::Cos;
+    else if (name == "tan" || name == "tg") func = ExprNode::Tan;
+    else if (name == "cot" || name == "ctg") func = ExprNode::Cot;
+    else if (name == "exp") func = ExprNode::Exp;
+    else if (name == "ln") func = ExprNode::Ln;
+    else if (name == "sqrt") func = ExprNode::Sqrt;
+    else if (name == "abs") func = ExprNode::Abs;
+    else if (name == "log") {
+        func = ExprNode::Log;
+        base = acceptOperator('_') ? parseLogBase() : ExprNode::number(10.0);
+        if (!base) return nullptr;
+    } else {
+        return nullptr;
+    }
+
+    if (!acceptOperator('(')) return nullptr;
+    ExprPtr arg = parseExpression();
+    if (!arg || !acceptOperator(')')) return nullptr;
+    return ExprNode::call(func, std::move(arg), std::move(base));
+}
+
+// Основание логарифма после '_': число, константа или выражение в скобках
+ExprPtr ExpressionReader::parseLogBase() {
+    const ExprToken token = peek();
+    if (token.type == ExprToken::Number) {
+        ++m_pos;
+        return ExprNode::number(token.value, true);
+    }
+    if (token.type == ExprToken::Identifier && (token.text == "e" || token.text == "pi")) {
+        ++m_pos;
+        return ExprNode::number(token.text == "e" ? M_E : M_PI);
+    }
+    if (acceptOperator('(')) {
+        ExprPtr inner = parseExpression();
+        if (!inner || !acceptOperator(')')) return nullptr;
+        return inner;
+    }
+    return nullptr;
+}
@@ -0,0 +1,94 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+
+// Узел синтаксического дерева выражения от одной переменной x
+struct ExprNode {
+    enum Type { Number, Variable, Negate, Add, Sub, Mul, Div, Pow, Call };
+    // Встроенные функции. Log: left — аргумент, right — основание
+    enum Func { Sin, Cos, Tan, Cot, Exp, Ln, Log, Sqrt, Abs };
+
+    Type type = Number;
+    Func func = Sin;
+    double value = 0.0;
+    // Число записано во входной строке (а не получено упрощением):
+    // такие числа — коэффициенты функции (Function::getCoefficients)
+    bool coefficient = false;
+    std::unique_ptr<ExprNode> left;
+    std::unique_ptr<ExprNode> right;
+
+    static std::unique_ptr<ExprNode> number(double v, bool coefficient = false);
+    static std::unique_ptr<ExprNode> variable();
+    static std::unique_ptr<ExprNode> unary(Type type, std::unique_ptr<ExprNode> arg);
+    static std::unique_ptr<ExprNode> binary(Type type, std::unique_ptr<ExprNode> l, std::unique_ptr<ExprNode> r);
+    static std::unique_ptr<ExprNode> call(Func func, std::unique_ptr<ExprNode> arg,
+                                          std::unique_ptr<ExprNode> base = nullptr);
+
+    // Поддерево не зависит от x
+    bool isConstant() const;
+    // Значение поддерева в точке x (для константных поддеревьев x не важен)
+    double evaluate(double x) const;
+};
+
+typedef std::unique_ptr<ExprNode> ExprPtr;
+
+// Оптимизация дерева перед вычислением: свёртка констант, удаление
+// тождественных операций (u*1, u+0, u^1, --u) и вынос не зависящих от x
+// вычислений из поточечного цикла: log_b(u) -> ln(u) * (1/ln b),
+// u/c -> (1/c) * u, c1*(c2*u) -> (c1*c2)*u
+class ExpressionSimplifier {
+public:
+    static ExprPtr simplify(ExprPtr node);
+
+private:
+    static bool isNumber(const ExprNode* node, double value);
+};
+
+// Лексема входной строки
+struct ExprToken {
+    enum Type { Number, Identifier, Operator, End };
+
+    Type type = End;
+    double value = 0.0;
+    QString text;
+    QChar op;
+};
+
+// Лексический анализатор и парсер рекурсивного спуска.
+// Грамматика:
+//   expr    := term (('+' | '-') term)*
+//   term    := unary (('*' | '/') unary | неявное умножение)*
+//   unary   := ('+' | '-') unary | power
+//   power   := primary ('^' unary)?
+//   primary := число | x | pi | e | '(' expr ')' | '|' expr '|'
+//            | функция '(' expr ')' | log_основание '(' expr ')'
+class ExpressionReader {
+public:
+    // Возвращает nullptr, если строка не является корректным выражением
+    static ExprPtr read(const QString& input);
+
+private:
+    explicit ExpressionReader(const QVector<ExprToken>& tokens);
+
+    static bool tokenize(const QString& input, QVector<ExprToken>& tokens);
+
+    ExprPtr parseExpression();
+    ExprPtr parseTerm();
+    ExprPtr parseUnary();
+    ExprPtr parsePower();
+    ExprPtr parsePrimary();
+    ExprPtr parseLogBase();
+
+    const ExprToken& peek() const;
+    bool acceptOperator(QChar op);
+    bool startsFactor(const ExprToken& token) const;
+
+    QVector<ExprToken> m_tokens;
+    int m_pos = 0;
+    int m_absDepth = 0;
+};
+
+#endif // EXPRESSION_H
@@ -1,16 +1,141 @@
 #include "Function.h"
+#include "VectorMath.h"
+#include <algorithm>
+#include <limits>
+
+// Реализация по умолчанию: поточечный вызов evaluate(double)
+void Function::evaluate(const double* xs, double* ys, int n) const {
+    for (int i = 0; i < n; ++i) {
+        ys[i] = evaluate(xs[i]);
+    }
+}
+
+void Function::domain(double& lower, double& upper) const {
+    lower = -std::numeric_limits<double>::infinity();
+    upper = std::numeric_limits<double>::infinity();
+}
+
+bool Function::singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const {
+    Q_UNUSED(lower);
+    Q_UNUSED(upper);
+    Q_UNUSED(maxCount);
+    breaks.clear();
+    // Непрерывная на всей оси функция разрывов не имеет
+    return !(capabilities() & (HasAsymptotes | BoundedDomain));
+}
+
+void Function::breakpoints(double lower, double upper, QVector<double>& points) const {
+    Q_UNUSED(lower);
+    Q_UNUSED(upper);
+    points.clear();
+}
+
+Interval Function::bounds(double lower, double upper) const {
+    Q_UNUSED(lower);
+    Q_UNUSED(upper);
+    return Interval::invalid();
+}
 
 // Многочлен: a0 + a1*x + a2*x^2 + ...
+// Схема Горнера: одно умножение и одно сложение на коэффициент
 double PolynomialFunction::evaluate(double x) const {
     double result = 0;
-    double power = 1;
-    for (double c : coefficients) {
-        result += c * power;
-        power *= x;
+    for (int k = coefficients.size() - 1; k >= 0; --k) {
+        result = result * x + coefficients[k];
     }
     return result;
 }
 
+// Горнер для степени, известной при компиляции: цикл разворачивается
+// в линейный код, а внешний цикл по точкам векторизуется
+template <int Degree>
+static void evaluateHorner(const double* c, const double* xs, double* ys, int n) {
+    for (int i = 0; i < n; ++i) {
+        const double x = xs[i];
+        double result = c[Degree];
+        for (int k = Degree - 1; k >= 0; --k) {
+            result = result * x + c[k];
+        }
+        ys[i] = result;
+    }
+}
+
+// Схема Эстрина для высоких степеней: пары коэффициентов c[2k] + c[2k+1]*x
+// сворачиваются попарно с множителями x^2, x^4, ... Цепочка зависимостей
+// имеет длину log2(степени), а каждый уровень — независимый цикл по блоку точек
+static void evaluateEstrin(const double* c, int count, const double* xs, double* ys, int n) {
+    const int BlockSize = 256;
+    const int pairs = (count + 1) / 2;
+    QVector<double> buffer((pairs + 1) * BlockSize);
+    double* power = buffer.data() + pairs * BlockSize;
+
+    for (int start = 0; start < n; start += BlockSize) {
+        const int m = std::min(BlockSize, n - start);
+        const double* x = xs + start;
+
+        for (int k = 0; k < pairs; ++k) {
+            double* t = buffer.data() + k * BlockSize;
+            const double c0 = c[2 * k];
+            const double c1 = 2 * k + 1 < count ? c[2 * k + 1] : 0.0;
+            for (int i = 0; i < m; ++i) {
+                t[i] = c0 + c1 * x[i];
+            }
+        }
+        for (int i = 0; i < m; ++i) {
+            power[i] = x[i] * x[i];
+        }
+
+        // Свёртка на месте: слагаемое k читает 2k и 2k+1, поэтому
+        // проход по возрастанию k ничего не затирает раньше времени
+        for (int terms = pairs; terms > 1; ) {
+            const int half = (terms + 1) / 2;
+            for (int k = 0; k < half; ++k) {
+                double* t = buffer.data() + k * BlockSize;
+                const double* lo = buffer.data() + 2 * k * BlockSize;
+                if (2 * k + 1 < terms) {
+                    const double* hi = lo + BlockSize;
+                    for (int i = 0; i < m; ++i) {
+                        t[i] = lo[i] + hi[i] * power[i];
+                    }
+                } else if (t != lo) {
+                    std::copy(lo, lo + m, t);
+                }
+            }
+            if (half > 1) {
+                for (int i = 0; i < m; ++i) {
+                    power[i] *= power[i];
+                }
+            }
+            terms = half;
+        }
+
+        std::copy(buffer.constData(), buffer.constData() + m, ys + start);
+    }
+}
+
+void PolynomialFunction::evaluate(const double* xs, double* ys, int n) const {
+    const double* coeffs = coefficients.constData();
+    // Старшие нулевые коэффициенты не влияют на результат
+    int count = coefficients.size();
+    while (count > 0 && coeffs[count - 1] == 0.0) {
+        --count;
+    }
+
+    switch (count) {
+    case 0: std::fill(ys, ys + n, 0.0); break;
+    case 1: std::fill(ys, ys + n, coeffs[0]); break;
+    case 2: evaluateHorner<1>(coeffs, xs, ys, n); break;
+    case 3: evaluateHorner<2>(coeffs, xs, ys, n); break;
+    case 4: evaluateHorner<3>(coeffs, xs, ys, n); break;
+    case 5: evaluateHorner<4>(coeffs, xs, ys, n); break;
+    case 6: evaluateHorner<5>(coeffs, xs, ys, n); break;
+    case 7: evaluateHorner<6>(coeffs, xs, ys, n); break;
+    case 8: evaluateHorner<7>(coeffs, xs, ys, n); break;
+    case 9: evaluateHorner<8>(coeffs, xs, ys, n); break;
+    default: evaluateEstrin(coeffs, count, xs, ys, n); break;
+    }
+}
+
 void PolynomialFunction::setCoefficients(const QVector<double>& coeffs) {
     coefficients = coeffs;
 }
@@ -23,6 +148,25 @@ QString PolynomialFunction::getName() const {
     return "Polynomial";
 }
 
+int PolynomialFunction::capabilities() const {
+    // Степень не выше первой — прямая без изломов
+    int count = coefficients.size();
+    while (count > 0 && coefficients[count - 1] == 0.0) {
+        --count;
+    }
+    return count <= 2 ? PiecewiseLinear : 0;
+}
+
+Interval PolynomialFunction::bounds(double lower, double upper) const {
+    // Горнер над интервалами: оценка тем точнее, чем уже отрезок
+    const Interval x(lower, upper);
+    Interval result(0.0);
+    for (int k = coefficients.size() - 1; k >= 0; --k) {
+        result = result * x + coefficients[k];
+    }
+    return result;
+}
+
 // Тригонометрические функции вида a * sin(b * x + c) + d
 TrigonometricFunction::TrigonometricFunction()
     : funcType(Sin), coefficients({0.0, 1.0, 1.0, 0.0}) {}
@@ -49,13 +193,44 @@ double TrigonometricFunction::evaluate(double x) const {
     case Cos: return d + a * cos(val);
     case Tan: return d + a * tan(val);
     case Cot: {
+        // В полюсе — NaN: график рвётся, а не идёт через ноль
         double t = tan(val);
-        return d + (t != 0 ? a / t : 0);
+        return t != 0 ? d + a / t : std::numeric_limits<double>::quiet_NaN();
     }
     }
     return 0;
 }
 
+void TrigonometricFunction::evaluate(const double* xs, double* ys, int n) const {
+    const double d = coefficients.size() > 0 ? coefficients[0] : 0.0;
+    const double a = coefficients.size() > 1 ? coefficients[1] : 1.0;
+    const double b = coefficients.size() > 2 ? coefficients[2] : 1.0;
+    const double c = coefficients.size() > 3 ? coefficients[3] : 0.0;
+
+    // Сначала аргументы, затем одна векторная функция на весь массив
+    for (int i = 0; i < n; ++i) {
+        ys[i] = b * xs[i] + c;
+    }
+
+    switch (funcType) {
+    case Sin: VectorMath::sin(ys, ys, n); break;
+    case Cos: VectorMath::cos(ys, ys, n); break;
+    case Tan:
+    case Cot: VectorMath::tan(ys, ys, n); break;
+    }
+
+    if (funcType == Cot) {
+        for (int i = 0; i < n; ++i) {
+            double t = ys[i];
+            ys[i] = t != 0 ? d + a / t : std::numeric_limits<double>::quiet_NaN();
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            ys[i] = d + a * ys[i];
+        }
+    }
+}
+
 void TrigonometricFunction::setCoefficients(const QVector<double>& coeffs) {
     coefficients = coeffs;
     while (coefficients.size() < 4) {
@@ -77,6 +252,71 @@ QString TrigonometricFunction::getName() const {
     return "Trigonometric";
 }
 
+int TrigonometricFunction::capabilities() const {
+    // При b = 0 функция постоянна
+    if (coefficients.value(2, 1.0) == 0.0) {
+        return 0;
+    }
+    if (funcType == Tan || funcType == Cot) {
+        return Periodic | HasAsymptotes;
+    }
+    return Periodic;
+}
+
+double TrigonometricFunction::period() const {
+    const double b = std::abs(coefficients.value(2, 1.0));
+    if (b == 0.0) {
+        return 0.0;
+    }
+    return (funcType == Tan || funcType == Cot ? M_PI : 2 * M_PI) / b;
+}
+
+bool TrigonometricFunction::singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const {
+    breaks.clear();
+    const double b = coefficients.value(2, 1.0);
+    const double c = coefficients.value(3, 0.0);
+    if ((funcType != Tan && funcType != Cot) || b == 0.0) {
+        return true;
+    }
+
+    // Полюса: b*x + c = offset + k*pi (tan — offset = pi/2, cot — 0)
+    const double offset = funcType == Tan ? M_PI / 2 : 0.0;
+    double u0 = b * lower + c;
+    double u1 = b * upper + c;
+    if (u0 > u1) {
+        std::swap(u0, u1);
+    }
+    const double kFirst = std::ceil((u0 - offset) / M_PI);
+    const double kLast = std::floor((u1 - offset) / M_PI);
+    // Полюсов больше, чем можно показать: ищем по значениям
+    if (kLast - kFirst >= maxCount) {
+        return false;
+    }
+    for (double k = kFirst; k <= kLast; ++k) {
+        breaks.append((offset + k * M_PI - c) / b);
+    }
+    if (b < 0) {
+        std::reverse(breaks.begin(), breaks.end());
+    }
+    return true;
+}
+
+Interval TrigonometricFunction::bounds(double lower, double upper) const {
+    const double d = coefficients.value(0, 0.0);
+    const double a = coefficients.value(1, 1.0);
+    const double b = coefficients.value(2, 1.0);
+    const double c = coefficients.value(3, 0.0);
+    const Interval u = Interval(lower, upper) * b + c;
+
+    switch (funcType) {
+    case Sin: return Interval::sin(u) * a + d;
+    case Cos: return Interval::cos(u) * a + d;
+    case Tan: return Interval::tan(u) * a + d;
+    case Cot: return Interval::cot(u) * a + d;
+    }
+    return Interval::invalid();
+}
+
 // Экспоненциальные функции вида a * exp(b * x + c) + d
 ExponentialFunction::ExponentialFunction() : coefficients({0.0, 1.0, 1.0, 0.0}) {}
 
@@ -88,6 +328,20 @@ double ExponentialFunction::evaluate(double x) const {
     return d + a * exp(b * x + c);
 }
 
+void ExponentialFunction::evaluate(const double* xs, double* ys, int n) const {
+    const double d = coefficients.size() > 0 ? coefficients[0] : 0.0;
+    const double a = coefficients.size() > 1 ? coefficients[1] : 1.0;
+    const double b = coefficients.size() > 2 ? coefficients[2] : 1.0;
+    const double c = coefficients.size() > 3 ? coefficients[3] : 0.0;
+    for (int i = 0; i < n; ++i) {
+        ys[i] = b * xs[i] + c;
+    }
+    VectorMath::exp(ys, ys, n);
+    for (int i = 0; i < n; ++i) {
+        ys[i] = d + a * ys[i];
+    }
+}
+
 void ExponentialFunction::setCoefficients(const QVector<double>& coeffs) {
     coefficients = coeffs;
     while (coefficients.size() < 4) {
@@ -103,27 +357,53 @@ QString ExponentialFunction::getName() const {
     return "ExponentialWithOffset";
 }
 
+Interval ExponentialFunction::bounds(double lower, double upper) const {
+    const double d = coefficients.value(0, 0.0);
+    const double a = coefficients.value(1, 1.0);
+    const double b = coefficients.value(2, 1.0);
+    const double c = coefficients.value(3, 0.0);
+    return Interval::exp(Interval(lower, upper) * b + c) * a + d;
+}
+
 // Логарифмические функции вида a * log_b(c * x + d) + e
-LogarithmicFunction::LogarithmicFunction() : coefficients({1.0, 10.0, 1.0, 0.0, 0.0}) {}
+LogarithmicFunction::LogarithmicFunction()
+    : coefficients({1.0, 10.0, 1.0, 0.0, 0.0}), invLogBase(1.0 / std::log(10.0)) {}
 
 double LogarithmicFunction::evaluate(double x) const {
     double a = coefficients.value(0, 1.0);
-    double base = coefficients.value(1, 10.0);
     double c = coefficients.value(2, 1.0);
     double d = coefficients.value(3, 0.0);
     double e = coefficients.value(4, 0.0);
 
     double arg = c * x + d;
 
+    // Вне области определения — NaN: разрыв графика, который не влияет
+    // на автомасштаб
     if (arg <= 0.0) {
-        return (a > 0) ? -1e10 : 1e10;
+        return std::numeric_limits<double>::quiet_NaN();
     }
 
-    if (arg < NEAR_ZERO_THRESHOLD) {
-        return (a > 0) ? -1e10 : 1e10;
-    }
+    return e + a * (std::log(arg) * invLogBase);
+}
 
-    return e + a * (std::log(arg) / std::log(base));
+void LogarithmicFunction::evaluate(const double* xs, double* ys, int n) const {
+    const double a = coefficients.value(0, 1.0);
+    const double c = coefficients.value(2, 1.0);
+    const double d = coefficients.value(3, 0.0);
+    const double e = coefficients.value(4, 0.0);
+    const double outOfDomain = std::numeric_limits<double>::quiet_NaN();
+    // Для arg < 0 ln даёт NaN, для arg = 0 — -inf: сравнение ниже
+    // отправляет оба случая в outOfDomain
+    const double minusInf = -std::numeric_limits<double>::infinity();
+
+    for (int i = 0; i < n; ++i) {
+        ys[i] = c * xs[i] + d;
+    }
+    VectorMath::log(ys, ys, n);
+    for (int i = 0; i < n; ++i) {
+        const double lnArg = ys[i];
+        ys[i] = (lnArg > minusInf) ? e + a * (lnArg * invLogBase) : outOfDomain;
+    }
 }
 
 void LogarithmicFunction::setCoefficients(const QVector<double>& coeffs) {
@@ -133,6 +413,7 @@ void LogarithmicFunction::setCoefficients(const QVector<double>& coeffs) {
         else if (coefficients.size() == 3) coefficients.append(0.0);
         else coefficients.append(0.0);
     }
+    invLogBase = 1.0 / std::log(coefficients[1]);
 }
 
 QVector<double> LogarithmicFunction::getCoefficients() const {
@@ -143,6 +424,50 @@ QString LogarithmicFunction::getName() const {
     return "Logarithmic";
 }
 
+int LogarithmicFunction::capabilities() const {
+    // При c = 0 аргумент не зависит от x
+    if (coefficients.value(2, 1.0) == 0.0) {
+        return 0;
+    }
+    return HasAsymptotes | BoundedDomain;
+}
+
+bool LogarithmicFunction::singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const {
+    Q_UNUSED(maxCount); // разрыв не больше одного
+    breaks.clear();
+    const double c = coefficients.value(2, 1.0);
+    const double d = coefficients.value(3, 0.0);
+    // Граница области определения c*x + d = 0 — она же асимптота
+    if (c != 0.0) {
+        const double x = -d / c;
+        if (x >= lower && x <= upper) {
+            breaks.append(x);
+        }
+    }
+    return true;
+}
+
+void LogarithmicFunction::domain(double& lower, double& upper) const {
+    Function::domain(lower, upper);
+    const double c = coefficients.value(2, 1.0);
+    const double d = coefficients.value(3, 0.0);
+    // c * x + d > 0
+    if (c > 0) {
+        lower = -d / c;
+    } else if (c < 0) {
+        upper = -d / c;
+    }
+}
+
+Interval LogarithmicFunction::bounds(double lower, double upper) const {
+    const double a = coefficients.value(0, 1.0);
+    const double c = coefficients.value(2, 1.0);
+    const double d = coefficients.value(3, 0.0);
+    const double e = coefficients.value(4, 0.0);
+    // Отрезок, задевающий arg <= 0, оценки не имеет
+    return Interval::log(Interval(lower, upper) * c + d) * (a * invLogBase) + e;
+}
+
 // Модульная функции вида c * |a * x + b| + d
 ModulusFunction::ModulusFunction() : coefficients({0.0, 0.0, 1.0, 1.0}) {}
 
@@ -155,6 +480,16 @@ double ModulusFunction::evaluate(double x) const {
     return d + c * std::abs(a * x + b);
 }
 
+void ModulusFunction::evaluate(const double* xs, double* ys, int n) const {
+    const double b = coefficients.size() > 0 ? coefficients[0] : 0.0;
+    const double d = coefficients.size() > 1 ? coefficients[1] : 0.0;
+    const double a = coefficients.size() > 2 ? coefficients[2] : 1.0;
+    const double c = coefficients.size() > 3 ? coefficients[3] : 1.0;
+    for (int i = 0; i < n; ++i) {
+        ys[i] = d + c * std::abs(a * xs[i] + b);
+    }
+}
+
 void ModulusFunction::setCoefficients(const QVector<double>& coeffs) {
     coefficients = coeffs;
     while (coefficients.size() < 4) {
@@ -169,3 +504,26 @@ QVector<double> ModulusFunction::getCoefficients() const {
 QString ModulusFunction::getName() const {
     return "Modulus";
 }
+
+void ModulusFunction::breakpoints(double lower, double upper, QVector<double>& points) const {
+    points.clear();
+    const double b = coefficients.size() > 0 ? coefficients[0] : 0.0;
+    const double a = coefficients.size() > 2 ? coefficients[2] : 1.0;
+    const double c = coefficients.size() > 3 ? coefficients[3] : 1.0;
+    // Излом там, где a*x + b = 0; при a = 0 или c = 0 функция постоянна
+    if (a == 0.0 || c == 0.0) {
+        return;
+    }
+    const double x = -b / a;
+    if (x > lower && x < upper) {
+        points.append(x);
+    }
+}
+
+Interval ModulusFunction::bounds(double lower, double upper) const {
+    const double b = coefficients.size() > 0 ? coefficients[0] : 0.0;
+    const double d = coefficients.size() > 1 ? coefficients[1] : 0.0;
+    const double a = coefficients.size() > 2 ? coefficients[2] : 1.0;
+    const double c = coefficients.size() > 3 ? coefficients[3] : 1.0;
+    return Interval::abs(Interval(lower, upper) * a + b) * c + d;
+}
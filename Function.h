@@ -4,15 +4,45 @@
 #include <QVector>
 #include <QString>
 #include <QtMath> // для sin, cos, tan, exp, log
+#include "Interval.h"
 
 // Абстрактный класс функции
 class Function {
 public:
+    // Вид функции: путь построения выбирается один раз, без сравнения имён
+    enum Kind { Polynomial, Trigonometric, Exponential, Logarithmic, Modulus, Expression };
+    // Свойства, известные аналитически
+    enum Capability {
+        HasAsymptotes = 0x1, // вертикальные асимптоты
+        BoundedDomain = 0x2, // определена не на всей оси, интервал — domain()
+        Periodic = 0x4,      // период — period()
+        PiecewiseLinear = 0x8 // линейна между точками излома — breakpoints()
+    };
+
     virtual ~Function() {}
     virtual double evaluate(double x) const = 0;
+    // Пакетное вычисление: ys[i] = f(xs[i]) для i = 0..n-1
+    virtual void evaluate(const double* xs, double* ys, int n) const;
     virtual void setCoefficients(const QVector<double>& coeffs) = 0;
     virtual QVector<double> getCoefficients() const = 0;
     virtual QString getName() const = 0;
+    virtual Kind kind() const = 0;
+    // Набор флагов Capability
+    virtual int capabilities() const { return 0; }
+    // Интервал lower < x < upper, вне которого функция не определена.
+    // Если он не известен аналитически — вся ось
+    virtual void domain(double& lower, double& upper) const;
+    // Наименьший положительный период, 0 — функция не периодична
+    virtual double period() const { return 0.0; }
+    // Точки разрыва (полюса и границы области определения) на отрезке
+    // [lower, upper] по возрастанию. false — разрывы аналитически не известны
+    // или их больше maxCount (тогда список не строится)
+    virtual bool singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const;
+    // Точки излома кусочно-линейной функции внутри (lower, upper) по возрастанию
+    virtual void breakpoints(double lower, double upper, QVector<double>& points) const;
+    // Границы значений на [lower, upper] по интервальной арифметике.
+    // Недействительный интервал — оценки нет (разрыв, край области определения)
+    virtual Interval bounds(double lower, double upper) const;
 };
 
 // Многочлен: a0 + a1*x + a2*x^2 + ...
@@ -23,9 +53,13 @@ public:
     explicit PolynomialFunction(const QVector<double>& coeffs) : coefficients(coeffs) {}
 
     double evaluate(double x) const override;
+    void evaluate(const double* xs, double* ys, int n) const override;
     void setCoefficients(const QVector<double>& coeffs) override;
     QVector<double> getCoefficients() const override;
     QString getName() const override;
+    Kind kind() const override { return Polynomial; }
+    Interval bounds(double lower, double upper) const override;
+    int capabilities() const override;
 };
 
 // Тригонометрические функции вида a * sin(b * x + c) + d
@@ -44,9 +78,15 @@ public:
     Type getType() const;
 
     double evaluate(double x) const override;
+    void evaluate(const double* xs, double* ys, int n) const override;
     void setCoefficients(const QVector<double>& coeffs) override;
     QVector<double> getCoefficients() const override;
     QString getName() const override;
+    Kind kind() const override { return Trigonometric; }
+    Interval bounds(double lower, double upper) const override;
+    int capabilities() const override;
+    double period() const override;
+    bool singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const override;
 };
 
 // Экспоненциальные функции вида a * exp(b * x + c) + d
@@ -56,22 +96,31 @@ public:
     ExponentialFunction();
 
     double evaluate(double x) const override;
+    void evaluate(const double* xs, double* ys, int n) const override;
     void setCoefficients(const QVector<double>& coeffs) override;
     QVector<double> getCoefficients() const override;
     QString getName() const override;
+    Kind kind() const override { return Exponential; }
+    Interval bounds(double lower, double upper) const override;
 };
 
 // Логарифмические функции вида a * log_b(c * x + d) + e
 class LogarithmicFunction : public Function {
     QVector<double> coefficients;
-    const double NEAR_ZERO_THRESHOLD = 1e-10;
+    double invLogBase; // 1 / ln(base), пересчитывается при смене коэффициентов
 public:
     LogarithmicFunction();
 
     double evaluate(double x) const override;
+    void evaluate(const double* xs, double* ys, int n) const override;
     void setCoefficients(const QVector<double>& coeffs) override;
     QVector<double> getCoefficients() const override;
     QString getName() const override;
+    Kind kind() const override { return Logarithmic; }
+    Interval bounds(double lower, double upper) const override;
+    int capabilities() const override;
+    void domain(double& lower, double& upper) const override;
+    bool singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const override;
 };
 
 // Модульная функции вида c * |a * x + b| + d
@@ -81,9 +130,14 @@ public:
     ModulusFunction();
 
     double evaluate(double x) const override;
+    void evaluate(const double* xs, double* ys, int n) const override;
     void setCoefficients(const QVector<double>& coeffs) override;
     QVector<double> getCoefficients() const override;
     QString getName() const override;
+    Kind kind() const override { return Modulus; }
+    Interval bounds(double lower, double upper) const override;
+    int capabilities() const override { return PiecewiseLinear; }
+    void breakpoints(double lower, double upper, QVector<double>& points) const override;
 };
 
 #endif // FUNCTION_H
@@ -0,0 +1,365 @@
+#include "FunctionSampler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void FunctionSampler::sample(const Function& func, double step, double yScale, const QCPRange& yCull,
+                             qint64 first, qint64 last, QVector<QCPGraphData>& data)
+{
+    // Один период выгоден, только если в куске их хотя бы два
+    const int period = periodNodes(func, step);
+    if (period > 0 && last - first >= 2 * period)
+        samplePeriodic(func, step, yScale, yCull, period, first, last, data);
+    else
+        sampleDirect(func, step, yScale, yCull, first, last, data);
+}
+
+QCPRange FunctionSampler::cullRange(const QCPRange& visible)
+{
+    const double margin = CullMargin * visible.size();
+    return QCPRange(visible.lower - margin, visible.upper + margin);
+}
+
+QCPRange FunctionSampler::valueRange(const Function& func, double lower, double upper, bool& found)
+{
+    // Оценка на всём отрезке сразу слишком груба (у многочлена каждое
+    // вхождение x расширяет интервал), по частям — близка к точной
+    found = false;
+    QCPRange range;
+    const double piece = (upper - lower) / BoundPieces;
+    for (int i = 0; i < BoundPieces; ++i)
+    {
+        const double x0 = lower + i * piece;
+        const double x1 = i + 1 == BoundPieces ? upper : lower + (i + 1) * piece;
+        const Interval y = func.bounds(x0, x1);
+        if (!y.isValid() || !std::isfinite(y.lower) || !std::isfinite(y.upper))
+            continue;
+        if (found)
+            range.expand(QCPRange(y.lower, y.upper));
+        else
+            range = QCPRange(y.lower, y.upper);
+        found = true;
+    }
+    return range;
+}
+
+bool FunctionSampler::samplePiecewiseLinear(const Function& func, double lower, double upper,
+                                            QVector<QCPGraphData>& data)
+{
+    if (!(func.capabilities() & Function::PiecewiseLinear))
+        return false;
+
+    QVector<double> xs;
+    func.breakpoints(lower, upper, xs);
+    xs.prepend(lower);
+    xs.append(upper);
+    QVector<double> ys(xs.size());
+    func.evaluate(xs.constData(), ys.data(), xs.size());
+
+    data.resize(xs.size());
+    for (int i = 0; i < xs.size(); ++i)
+        data[i] = QCPGraphData(xs[i], ys[i]);
+    return true;
+}
+
+double FunctionSampler::alignedStep(const Function& func, double step)
+{
+    const double period = func.period();
+    if (!(period > 0))
+        return step;
+    const double nodes = std::round(period / step);
+    if (nodes < MinPeriodNodes)
+        return step;
+    return period / nodes;
+}
+
+// Число узлов сетки на период; 0 — функция не периодична или сетка
+// с периодом не согласована (тогда вычисляем напрямую)
+int FunctionSampler::periodNodes(const Function& func, double step)
+{
+    const double period = func.period();
+    if (!(period > 0))
+        return 0;
+    const double nodes = std::round(period / step);
+    if (nodes < MinPeriodNodes || nodes > std::numeric_limits<int>::max() ||
+        std::abs(nodes * step - period) > period * 1e-9)
+        return 0;
+    return static_cast<int>(nodes);
+}
+
+void FunctionSampler::samplePeriodic(const Function& func, double step, double yScale, const QCPRange& yCull,
+                                     int period, qint64 first, qint64 last, QVector<QCPGraphData>& data)
+{
+    // Ломаная на одном периоде: узлы 0..period с уточнением и разрывами.
+    // Узлы таблицы нужны все, поэтому блоки узлов в ней не отсекаются
+    thread_local QVector<QCPGraphData> table;
+    thread_local QVector<int> nodeAt; // индекс j-го узла в table
+    const double infinity = std::numeric_limits<double>::infinity();
+    sampleDirect(func, step, yScale, QCPRange(-infinity, infinity), 0, period, table);
+
+    nodeAt.resize(period + 1);
+    int j = 0;
+    for (int i = 0; i < table.size() && j <= period; ++i)
+    {
+        if (table[i].key == j * step)
+            nodeAt[j++] = i;
+    }
+    if (j != period + 1)
+    {
+        sampleDirect(func, step, yScale, yCull, first, last, data);
+        return;
+    }
+
+    // Узел k повторяет узел k mod period, точки между узлами переносятся
+    // сдвигом. Ключи узлов считаются заново, чтобы совпадать с сеткой точно
+    data.clear();
+    data.reserve(static_cast<int>((last - first) / period + 1) * (table.size() - 1) + 1);
+    for (qint64 k = first; k <= last; ++k)
+    {
+        const int r = static_cast<int>(((k % period) + period) % period);
+        const double base = k * step;
+        data.append(QCPGraphData(base, table[nodeAt[r]].value));
+        if (k == last)
+            break;
+
+        const double shift = base - r * step;
+        for (int i = nodeAt[r] + 1; i < nodeAt[r + 1]; ++i)
+            data.append(QCPGraphData(table[i].key + shift, table[i].value));
+    }
+}
+
+void FunctionSampler::sampleDirect(const Function& func, double step, double yScale, const QCPRange& yCull,
+                                   qint64 first, qint64 last, QVector<QCPGraphData>& data)
+{
+    // Рабочие массивы живут в потоке и переиспользуются между вызовами
+    thread_local QVector<double> xs, ys;
+
+    // Узлы сетки first..last и одно пакетное вычисление. Блок узлов, где
+    // функция по оценке целиком вне yCull, представлен крайними узлами:
+    // отрезок между ними тоже вне yCull и на экран не попадает
+    const bool cull = std::isfinite(yCull.lower) || std::isfinite(yCull.upper);
+    xs.resize(0);
+    xs.reserve(static_cast<int>(last - first + 1));
+    for (qint64 k = first; k < last; k += CullNodes)
+    {
+        const qint64 end = std::min(k + CullNodes, last);
+        xs.append(k * step);
+        if (cull && end - k > 1 && isCulled(func.bounds(k * step, end * step), yCull))
+            continue;
+        for (qint64 j = k + 1; j < end; ++j)
+            xs.append(j * step);
+    }
+    xs.append(last * step);
+    const int count = xs.size();
+    ys.resize(count);
+    func.evaluate(xs.constData(), ys.data(), count);
+
+    data.resize(count);
+    QCPGraphData* out = data.data();
+    for (int i = 0; i < count; ++i)
+    {
+        out[i] = QCPGraphData(xs[i], ys[i]);
+    }
+
+    // Вариант уточнения выбирается один раз на вызов, а не на каждую точку
+    thread_local QVector<double> breaks;
+    breaks.clear();
+    if (!(func.capabilities() & (Function::HasAsymptotes | Function::BoundedDomain)))
+    {
+        refine<Continuous>(func, yScale, yCull, breaks, data);
+    }
+    else if (func.singularities(first * step, last * step, count, breaks))
+    {
+        refine<Analytic>(func, yScale, yCull, breaks, data);
+        insertBreaks(func, step, breaks, data);
+    }
+    else
+    {
+        refine<Unknown>(func, yScale, yCull, breaks, data);
+    }
+}
+
+template <FunctionSampler::Mode M>
+void FunctionSampler::refine(const Function& func, double yScale, const QCPRange& yCull,
+                             const QVector<double>& breaks, QVector<QCPGraphData>& data)
+{
+    thread_local QVector<double> xs, ys;
+    thread_local QVector<QCPGraphData> segments, next;
+
+    // Отрезки, содержащие известный разрыв, не уточняются: около разрыва
+    // точки расставит insertBreaks
+    segments.resize(0); // концы отрезков парами
+    int b = 0;
+    for (int i = 0; i + 1 < data.size(); ++i)
+    {
+        if (M == Analytic)
+        {
+            while (b < breaks.size() && breaks[b] < data[i].key)
+                ++b;
+            if (b < breaks.size() && breaks[b] <= data[i + 1].key)
+                continue;
+        }
+        segments.append(data[i]);
+        segments.append(data[i + 1]);
+    }
+
+    // Уточнение по уровням: середины всех подозрительных отрезков уровня
+    // вычисляются одним пакетом. Середина остаётся в данных, только если
+    // ломаная отклоняется от функции больше чем на TolerancePixels
+    for (int depth = 0; depth < MaxRefineDepth && !segments.isEmpty(); ++depth)
+    {
+        const int m = segments.size() / 2;
+        xs.resize(m);
+        ys.resize(m);
+        for (int j = 0; j < m; ++j)
+        {
+            xs[j] = 0.5 * (segments[2 * j].key + segments[2 * j + 1].key);
+        }
+        func.evaluate(xs.constData(), ys.data(), m);
+
+        const int before = data.size();
+        next.resize(0);
+        for (int j = 0; j < m; ++j)
+        {
+            const QCPGraphData& a = segments[2 * j];
+            const QCPGraphData& b = segments[2 * j + 1];
+            if (!deviates<M>(a.value, ys[j], b.value, yScale))
+                continue;
+            // Отклонение есть, но делить дальше незачем, если по оценке функция
+            // на отрезке целиком вне yCull или укладывается в BoundPixels
+            const Interval bounds = func.bounds(a.key, b.key);
+            if (isCulled(bounds, yCull) ||
+                (bounds.isValid() && (bounds.upper - bounds.lower) * yScale <= BoundPixels))
+                continue;
+
+            QCPGraphData mid(xs[j], ys[j]);
+            data.append(mid);
+            next << a << mid << mid << b;
+        }
+        mergeTail(data, before);
+        segments.swap(next);
+    }
+
+    // Отрезки, которые так и не сошлись: огромный скачок со сменой знака —
+    // полюс, через который нельзя проводить линию
+    if (M == Unknown)
+    {
+        const int before = data.size();
+        for (int j = 0; j < segments.size() / 2; ++j)
+        {
+            const QCPGraphData& a = segments[2 * j];
+            const QCPGraphData& b = segments[2 * j + 1];
+            if (a.value * b.value < 0 && std::abs(b.value - a.value) * yScale > JumpPixels)
+            {
+                data.append(QCPGraphData(0.5 * (a.key + b.key), std::numeric_limits<double>::quiet_NaN()));
+            }
+        }
+        mergeTail(data, before);
+    }
+}
+
+bool FunctionSampler::isCulled(const Interval& bounds, const QCPRange& yCull)
+{
+    return bounds.isValid() && (bounds.upper < yCull.lower || bounds.lower > yCull.upper);
+}
+
+template <FunctionSampler::Mode M>
+bool FunctionSampler::deviates(double ya, double ym, double yb, double yScale)
+{
+    if (M != Continuous)
+    {
+        const bool fa = std::isfinite(ya);
+        const bool fm = std::isfinite(ym);
+        const bool fb = std::isfinite(yb);
+        if (!fa || !fm || !fb)
+        {
+            // Граница области определения внутри отрезка: известные границы
+            // уже учтены, неизвестные ищем делением пополам
+            return M == Unknown && (fa || fm || fb);
+        }
+    }
+    return std::abs(ym - 0.5 * (ya + yb)) * yScale > TolerancePixels;
+}
+
+void FunctionSampler::insertBreaks(const Function& func, double step, const QVector<double>& breaks,
+                                   QVector<QCPGraphData>& data)
+{
+    if (breaks.isEmpty() || data.isEmpty())
+        return;
+
+    thread_local QVector<double> xs, ys;
+    const double lower = data.first().key;
+    const double upper = data.last().key;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const auto byKey = [](const QCPGraphData& a, const QCPGraphData& b) { return a.key < b.key; };
+
+    // Разрывов не больше, чем узлов (см. singularities в sampleDirect). Если
+    // их столько же, что узлов, график всё равно неразличим: ставим только
+    // сами разрывы
+    const bool approach = breaks.size() < data.size();
+
+    xs.resize(0);
+    const int before = data.size();
+    for (int i = 0; i < breaks.size(); ++i)
+    {
+        const double s = breaks[i];
+
+        // Разрыв в узле сетки: значение узла заменяем на NaN
+        auto node = std::lower_bound(data.begin(), data.begin() + before, QCPGraphData(s, 0), byKey);
+        const auto end = data.begin() + before;
+        const bool atNode = node != end && node->key == s;
+        const double prev = node != data.begin() ? (node - 1)->key : lower;
+        double next = node != end ? node->key : upper;
+        if (atNode)
+        {
+            next = node + 1 != end ? (node + 1)->key : upper;
+            node->value = nan;
+        }
+        else
+        {
+            data.append(QCPGraphData(s, nan));
+        }
+
+        if (!approach)
+            continue;
+
+        // Сгущение к разрыву с обеих сторон внутри отрезка между соседними
+        // точками, не заходя за середину до соседних разрывов
+        const double left = std::min(s - prev, i > 0 ? 0.5 * (s - breaks[i - 1]) : step);
+        const double right = std::min(next - s,
+                                      i + 1 < breaks.size() ? 0.5 * (breaks[i + 1] - s) : step);
+        double h = 0.5 * step;
+        for (int k = 0; k < ApproachLevels; ++k, h *= 0.5)
+        {
+            if (h < left)
+                xs.append(s - h);
+            if (h < right)
+                xs.append(s + h);
+        }
+    }
+
+    ys.resize(xs.size());
+    func.evaluate(xs.constData(), ys.data(), xs.size());
+    for (int j = 0; j < xs.size(); ++j)
+    {
+        // Точки вне области определения не нужны: разрыв уже отмечен
+        if (std::isfinite(ys[j]))
+            data.append(QCPGraphData(xs[j], ys[j]));
+    }
+
+    if (data.size() > before)
+    {
+        std::sort(data.begin() + before, data.end(), byKey);
+        mergeTail(data, before);
+    }
+}
+
+// Сливает отсортированный хвост data[before..] с отсортированным началом
+void FunctionSampler::mergeTail(QVector<QCPGraphData>& data, int before)
+{
+    if (data.size() > before)
+    {
+        std::inplace_merge(data.begin(), data.begin() + before, data.end(),
+                           [](const QCPGraphData& a, const QCPGraphData& b) { return a.key < b.key; });
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef FUNCTIONSAMPLER_H
+#define FUNCTIONSAMPLER_H
+
+#include "qcustomplot.h"
+#include "Function.h"
+
+// Построение ломаной функции на сетке x = k * step с адаптивным уточнением.
+// Не обращается к виджету, поэтому вызывается из рабочих потоков
+class FunctionSampler {
+public:
+    // Шаг базовой сетки и допустимое отклонение ломаной от функции
+    // в пикселях устройства; уточнение делит отрезок пополам не более
+    // MaxRefineDepth раз (до 1/8 пикселя)
+    static constexpr double GridPixels = 4.0;
+    static constexpr double TolerancePixels = 0.25;
+    static const int MaxRefineDepth = 5;
+    // Около известного разрыва точки ставятся на расстояниях step/2 .. step/2^ApproachLevels
+    static const int ApproachLevels = 10;
+    // Скачок (в пикселях) со сменой знака на самом мелком отрезке, который
+    // считается полюсом у функций без аналитических разрывов
+    static constexpr double JumpPixels = 1e4;
+
+    // Меньше узлов на период — колебания неразличимы, период не переиспользуется
+    static const int MinPeriodNodes = 4;
+
+    // Узлы сетки проверяются по Function::bounds блоками по CullNodes: у блока
+    // целиком вне yCull вычисляются только крайние узлы
+    static const int CullNodes = 16;
+    // Отрезок, где функция по оценке Function::bounds укладывается в полосу
+    // такой высоты (в пикселях устройства), дальше не делится
+    static constexpr double BoundPixels = 1.0;
+    // Запас yCull с каждой стороны видимого диапазона y, в его высотах
+    static constexpr double CullMargin = 1.0;
+    // На столько частей делится отрезок в valueRange
+    static const int BoundPieces = 256;
+
+    // Узлы сетки first..last и точки уточнения между ними по возрастанию x.
+    // Разрывы отмечаются точками со значением NaN — QCPGraph рвёт на них линию.
+    // yScale — пикселей устройства на единицу y. Где функция по оценке
+    // Function::bounds целиком вне yCull, ломаная идёт без подробностей:
+    // её отрезки там тоже вне yCull. Бесконечный yCull отключает отсечение
+    static void sample(const Function& func, double step, double yScale, const QCPRange& yCull,
+                       qint64 first, qint64 last, QVector<QCPGraphData>& data);
+
+    // yCull для видимого диапазона y: с запасом CullMargin, чтобы небольшие
+    // сдвиги по y не требовали пересчёта
+    static QCPRange cullRange(const QCPRange& visible);
+
+    // Диапазон значений функции на [lower, upper] по интервальным оценкам
+    // частей отрезка, без вычисления на сетке. Части, где оценки нет (разрывы),
+    // пропускаются; found = false — ни одной оценки
+    static QCPRange valueRange(const Function& func, double lower, double upper, bool& found);
+
+    // Точная ломаная кусочно-линейной функции на [lower, upper]: концы и точки
+    // излома между ними. false — функция не кусочно-линейна, data не меняется
+    static bool samplePiecewiseLinear(const Function& func, double lower, double upper,
+                                      QVector<QCPGraphData>& data);
+
+    // Шаг, близкий к step, с целым числом узлов на период функции: тогда
+    // сетка повторяется через период, и sample считает только один период.
+    // Для непериодических функций возвращает step
+    static double alignedStep(const Function& func, double step);
+
+private:
+    // Continuous — функция непрерывна на всей оси;
+    // Analytic — разрывы известны из Function::singularities;
+    // Unknown — разрывы ищутся по значениям
+    enum Mode { Continuous, Analytic, Unknown };
+
+    static void sampleDirect(const Function& func, double step, double yScale, const QCPRange& yCull,
+                             qint64 first, qint64 last, QVector<QCPGraphData>& data);
+    static void samplePeriodic(const Function& func, double step, double yScale, const QCPRange& yCull,
+                               int period, qint64 first, qint64 last, QVector<QCPGraphData>& data);
+    static int periodNodes(const Function& func, double step);
+
+    template <Mode M>
+    static void refine(const Function& func, double yScale, const QCPRange& yCull,
+                       const QVector<double>& breaks, QVector<QCPGraphData>& data);
+    static bool isCulled(const Interval& bounds, const QCPRange& yCull);
+    template <Mode M>
+    static bool deviates(double ya, double ym, double yb, double yScale);
+    static void insertBreaks(const Function& func, double step, const QVector<double>& breaks,
+                             QVector<QCPGraphData>& data);
+    static void mergeTail(QVector<QCPGraphData>& data, int before);
+};
+
+#endif // FUNCTIONSAMPLER_H
@@ -0,0 +1,50 @@
+# Общая часть редактора и пакетной отрисовки: функции, разбор выражений,
+# вычисление отсчётов и виджет графика
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+
+
+CONFIG += c++17
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+    $$PWD/ColumnGraph.cpp \
+    $$PWD/ColumnSeries.cpp \
+    $$PWD/CompiledFunction.cpp \
+    $$PWD/DecimatedGraph.cpp \
+    $$PWD/Expression.cpp \
+    $$PWD/Function.cpp \
+    $$PWD/FunctionSampler.cpp \
+    $$PWD/MappedGraph.cpp \
+    $$PWD/MappedSeries.cpp \
+    $$PWD/Parser.cpp \
+    $$PWD/StreamGraph.cpp \
+    $$PWD/VectorMath.cpp \
+    $$PWD/graphicwidget.cpp \
+    $$PWD/qcustomplot.cpp
+
+HEADERS += \
+    $$PWD/ColumnGraph.h \
+    $$PWD/ColumnSeries.h \
+    $$PWD/CompiledFunction.h \
+    $$PWD/DataStream.h \
+    $$PWD/DecimatedGraph.h \
+    $$PWD/Expression.h \
+    $$PWD/Function.h \
+    $$PWD/FunctionSampler.h \
+    $$PWD/Interval.h \
+    $$PWD/MappedGraph.h \
+    $$PWD/MappedSeries.h \
+    $$PWD/Parser.h \
+    $$PWD/StreamGraph.h \
+    $$PWD/VectorMath.h \
+    $$PWD/VectorMathKernels.h \
+    $$PWD/graphicwidget.h \
+    $$PWD/qcustomplot.h
+
+INCLUDEPATH += $$PWD
@@ -0,0 +1,20 @@
+# Пакетная отрисовка графиков без окна (платформа offscreen):
+#   GraphicEditorBatch [--size 800x600] [--processes N] jobs.txt
+
+include(GraphicEditor.pri)
+
+TARGET = GraphicEditorBatch
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += \
+    BatchRenderer.cpp \
+    batchmain.cpp
+
+HEADERS += \
+    BatchRenderer.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
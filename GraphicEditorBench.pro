@@ -0,0 +1,14 @@
+# Замеры производительности: время разбора выражений (QBENCHMARK) и число
+# вычислений функции при смене диапазонов. Запуск без make check:
+#   GraphicEditorBench [-iterations N] [имя замера]
+
+include(GraphicEditor.pri)
+
+QT += testlib
+
+TARGET = GraphicEditorBench
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += \
+    bench_graphiceditor.cpp
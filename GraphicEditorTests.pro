@@ -0,0 +1,12 @@
+# Модульные тесты (QtTest). Запуск: make check
+
+include(GraphicEditor.pri)
+
+QT += testlib
+
+TARGET = GraphicEditorTests
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    tst_graphiceditor.cpp
@@ -0,0 +1,198 @@
+#ifndef INTERVAL_H
+#define INTERVAL_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QtMath> // M_PI
+
+// Интервальная арифметика: по отрезку аргументов — отрезок, в котором
+// гарантированно лежат значения. Границы считаются в обычной точности,
+// поэтому гарантия — с точностью до округления (единицы ulp).
+// Недействительный интервал (isValid() == false) — оценки нет: отрезок
+// задевает полюс или выходит из области определения. Он поглощает
+// любые дальнейшие операции
+struct Interval
+{
+    double lower;
+    double upper;
+
+    Interval() : lower(std::numeric_limits<double>::quiet_NaN()), upper(lower) {}
+    Interval(double value) : lower(value), upper(value) {}
+    Interval(double low, double high) : lower(low), upper(high) {}
+
+    static Interval invalid() { return Interval(); }
+    // Сравнение с NaN ложно, поэтому NaN в границах тоже даёт false
+    bool isValid() const { return lower <= upper; }
+    bool contains(double value) const { return lower <= value && value <= upper; }
+
+    // Отрезок между двумя значениями в любом порядке: для монотонных функций
+    static Interval hull(double a, double b)
+    {
+        if (std::isnan(a) || std::isnan(b))
+            return invalid();
+        return a < b ? Interval(a, b) : Interval(b, a);
+    }
+
+    static Interval abs(const Interval& x)
+    {
+        if (!x.isValid())
+            return x;
+        if (x.contains(0.0))
+            return Interval(0.0, std::max(-x.lower, x.upper));
+        return hull(std::abs(x.lower), std::abs(x.upper));
+    }
+
+    static Interval sqrt(const Interval& x)
+    {
+        if (!x.isValid() || x.lower < 0.0)
+            return invalid();
+        return Interval(std::sqrt(x.lower), std::sqrt(x.upper));
+    }
+
+    static Interval exp(const Interval& x)
+    {
+        if (!x.isValid())
+            return x;
+        return Interval(std::exp(x.lower), std::exp(x.upper));
+    }
+
+    static Interval log(const Interval& x)
+    {
+        if (!x.isValid() || !(x.lower > 0.0))
+            return invalid();
+        return Interval(std::log(x.lower), std::log(x.upper));
+    }
+
+    // Степень с постоянным показателем
+    static Interval pow(const Interval& x, double p)
+    {
+        if (!x.isValid() || std::isnan(p))
+            return invalid();
+        if (p == 0.0)
+            return Interval(1.0);
+        if (p == std::floor(p))
+        {
+            // Целая степень монотонна по обе стороны от нуля
+            if (!x.contains(0.0))
+                return hull(std::pow(x.lower, p), std::pow(x.upper, p));
+            if (p < 0.0)
+                return invalid();
+            if (std::fmod(p, 2.0) == 0.0)
+                return Interval(0.0, std::pow(std::max(-x.lower, x.upper), p));
+            return Interval(std::pow(x.lower, p), std::pow(x.upper, p));
+        }
+        // Дробная степень определена при x >= 0, отрицательная — при x > 0
+        if (x.lower < 0.0 || (p < 0.0 && x.lower == 0.0))
+            return invalid();
+        return hull(std::pow(x.lower, p), std::pow(x.upper, p));
+    }
+
+    // Степень постоянного основания: c^x
+    static Interval pow(double base, const Interval& x)
+    {
+        if (!x.isValid() || std::isnan(base))
+            return invalid();
+        // При c > 0 монотонна по x
+        if (base > 0.0)
+            return hull(std::pow(base, x.lower), std::pow(base, x.upper));
+        // 0^x = 0 при x > 0; отрицательное основание — только целая степень
+        if (base == 0.0 && x.lower > 0.0)
+            return Interval(0.0);
+        if (x.lower == x.upper)
+            return hull(std::pow(base, x.lower), std::pow(base, x.lower));
+        return invalid();
+    }
+
+    static Interval sin(const Interval& x)
+    {
+        // Экстремумы в pi/2 + 2*pi*k (1) и -pi/2 + 2*pi*k (-1)
+        if (!x.isValid())
+            return x;
+        return extrema(x, M_PI / 2, std::sin(x.lower), std::sin(x.upper));
+    }
+
+    static Interval cos(const Interval& x)
+    {
+        // Экстремумы в 2*pi*k (1) и pi + 2*pi*k (-1)
+        if (!x.isValid())
+            return x;
+        return extrema(x, 0.0, std::cos(x.lower), std::cos(x.upper));
+    }
+
+    static Interval tan(const Interval& x)
+    {
+        // Между полюсами pi/2 + pi*k tan возрастает
+        if (!x.isValid() || containsPoint(x, M_PI / 2, M_PI))
+            return invalid();
+        return Interval(std::tan(x.lower), std::tan(x.upper));
+    }
+
+    static Interval cot(const Interval& x)
+    {
+        // Между полюсами pi*k cot убывает
+        if (!x.isValid() || containsPoint(x, 0.0, M_PI))
+            return invalid();
+        return Interval(1.0 / std::tan(x.upper), 1.0 / std::tan(x.lower));
+    }
+
+private:
+    // Аргументы, при которых приведение к периоду теряет точность
+    static constexpr double MaxTrigArgument = 1e6;
+
+    // Есть ли в x точка offset + period*k
+    static bool containsPoint(const Interval& x, double offset, double period)
+    {
+        if (x.upper - x.lower >= period || std::abs(x.lower) > MaxTrigArgument || std::abs(x.upper) > MaxTrigArgument)
+            return true;
+        return offset + period * std::ceil((x.lower - offset) / period) <= x.upper;
+    }
+
+    // sin и cos по значениям на концах: maximumAt — положение максимума
+    // на периоде 2*pi, минимум — через pi от него
+    static Interval extrema(const Interval& x, double maximumAt, double atLower, double atUpper)
+    {
+        const bool hasMaximum = containsPoint(x, maximumAt, 2 * M_PI);
+        const bool hasMinimum = containsPoint(x, maximumAt + M_PI, 2 * M_PI);
+        return Interval(hasMinimum ? -1.0 : std::min(atLower, atUpper),
+                        hasMaximum ? 1.0 : std::max(atLower, atUpper));
+    }
+};
+
+inline Interval operator-(const Interval& x)
+{
+    return Interval(-x.upper, -x.lower);
+}
+
+inline Interval operator+(const Interval& a, const Interval& b)
+{
+    return Interval(a.lower + b.lower, a.upper + b.upper);
+}
+
+inline Interval operator-(const Interval& a, const Interval& b)
+{
+    return Interval(a.lower - b.upper, a.upper - b.lower);
+}
+
+inline Interval operator*(const Interval& a, const Interval& b)
+{
+    if (!a.isValid() || !b.isValid())
+        return Interval::invalid();
+    const double p[4] = {a.lower * b.lower, a.lower * b.upper, a.upper * b.lower, a.upper * b.upper};
+    // 0 * inf — оценки нет
+    for (double v : p)
+    {
+        if (std::isnan(v))
+            return Interval::invalid();
+    }
+    return Interval(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+}
+
+inline Interval operator/(const Interval& a, const Interval& b)
+{
+    if (!b.isValid() || b.contains(0.0))
+        return Interval::invalid();
+    return a * Interval(1.0 / b.upper, 1.0 / b.lower);
+}
+
+#endif // INTERVAL_H
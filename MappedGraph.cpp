@@ -0,0 +1,95 @@
+#include "MappedGraph.h"
+#include <algorithm>
+#include <cmath>
+
+MappedGraph::MappedGraph(QCPAxis* keyAxis, QCPAxis* valueAxis, std::shared_ptr<const MappedSeries> series)
+    : QCPGraph(keyAxis, valueAxis), m_series(std::move(series))
+{
+}
+
+QCPRange MappedGraph::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    const MappedSeries& series = *m_series;
+    const QCPGraphData* data = series.data();
+    qint64 first = 0;
+    qint64 last = series.size();
+    // Ключи упорядочены: граница знака ищется двоичным поиском
+    if (inSignDomain == QCP::sdPositive)
+        first = series.upperBound(0.0);
+    else if (inSignDomain == QCP::sdNegative)
+        last = series.lowerBound(0.0);
+
+    foundRange = first < last;
+    return foundRange ? QCPRange(data[first].key, data[last - 1].key) : QCPRange();
+}
+
+QCPRange MappedGraph::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    if (inSignDomain != QCP::sdBoth)
+        return QCPGraph::getValueRange(foundRange, inSignDomain, inKeyRange);
+
+    qint64 from = 0;
+    qint64 to = m_series->size();
+    if (inKeyRange != QCPRange())
+    {
+        from = m_series->lowerBound(inKeyRange.lower);
+        to = m_series->upperBound(inKeyRange.upper);
+    }
+    return m_series->valueRange(from, to, foundRange);
+}
+
+void MappedGraph::draw(QCPPainter* painter)
+{
+    if (mKeyAxis)
+        updateView();
+    QCPGraph::draw(painter);
+}
+
+void MappedGraph::updateView()
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    const QCPRange range = keyAxis->range();
+    const int pixels = std::max(1, int(std::abs(keyAxis->coordToPixel(range.upper) - keyAxis->coordToPixel(range.lower))));
+    if (range == m_viewRange && pixels == m_viewPixels)
+        return;
+    m_viewRange = range;
+    m_viewPixels = pixels;
+
+    // Соседние с окном точки нужны, чтобы линия доходила до краёв
+    const MappedSeries& series = *m_series;
+    const qint64 from = std::max<qint64>(series.lowerBound(range.lower) - 1, 0);
+    const qint64 to = std::min(series.upperBound(range.upper) + 1, series.size());
+    const qint64 count = to - from;
+
+    // Самый грубый уровень индекса, сводка которого не шире пикселя
+    int level = -1;
+    while (level + 1 < series.levelCount() && series.levelSpan(level + 1) * pixels <= count)
+        ++level;
+
+    QVector<QCPGraphData> view;
+    if (level < 0)
+    {
+        // Точек на пиксель немного: копируем как есть, дальше прореживает QCPGraph
+        view.resize(int(count));
+        std::copy(series.data() + from, series.data() + to, view.begin());
+    }
+    else
+    {
+        // Каждая сводка — две точки: минимум в начале корзины, максимум в конце.
+        // В пределах пикселя порядок не важен, вертикальный размах сохраняется
+        const qint64 span = series.levelSpan(level);
+        const qint64 first = from / span;
+        const qint64 last = (to + span - 1) / span;
+        const MappedSeries::Summary* summaries = series.level(level);
+        view.reserve(int(2 * (last - first)));
+        for (qint64 b = first; b < last; ++b)
+        {
+            // Корзина из одних NaN даёт одну точку NaN — разрыв линии
+            const MappedSeries::Summary& s = summaries[b];
+            view.append(QCPGraphData(s.firstKey, s.minValue));
+            if (!std::isnan(s.minValue))
+                view.append(QCPGraphData(s.lastKey, s.maxValue));
+        }
+    }
+    mDataContainer->set(view, true);
+}
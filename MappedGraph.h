@@ -0,0 +1,36 @@
+#ifndef MAPPEDGRAPH_H
+#define MAPPEDGRAPH_H
+
+#include "qcustomplot.h"
+#include "MappedSeries.h"
+
+// График ряда из отображённого в память файла. Данные не загружаются
+// целиком: перед отрисовкой в контейнер графика попадает только видимый
+// участок — сами точки при крупном масштабе или сводки индекса, не шире
+// пикселя, при мелком. Разрывы из NaN внутри сводок не видны, пока
+// участок не станет достаточно крупным
+class MappedGraph : public QCPGraph
+{
+    Q_OBJECT
+
+public:
+    MappedGraph(QCPAxis* keyAxis, QCPAxis* valueAxis, std::shared_ptr<const MappedSeries> series);
+
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    // Для sdBoth — по сводкам всего ряда, иначе — по видимому участку
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+
+private:
+    void updateView();
+
+    std::shared_ptr<const MappedSeries> m_series;
+    // Для какого диапазона и ширины в пикселях собран контейнер
+    QCPRange m_viewRange;
+    int m_viewPixels = 0;
+};
+
+#endif // MAPPEDGRAPH_H
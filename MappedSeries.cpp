@@ -0,0 +1,290 @@
+#include "MappedSeries.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Точки файла читаются и пишутся как массив QCPGraphData
+static_assert(sizeof(QCPGraphData) == 2 * sizeof(double), "QCPGraphData must be a plain (key, value) pair");
+static_assert(sizeof(MappedSeries::Header) == 64, "unexpected header layout");
+static_assert(sizeof(MappedSeries::Summary) == 4 * sizeof(double), "unexpected summary layout");
+
+const char MappedSeries::Magic[8] = {'G', 'E', 'S', 'E', 'R', 'I', 'E', 'S'};
+
+std::shared_ptr<const MappedSeries> MappedSeries::open(const QString& fileName, QString* error)
+{
+    std::shared_ptr<MappedSeries> series(new MappedSeries);
+    auto fail = [error](const QString& reason) -> std::shared_ptr<const MappedSeries> {
+        if (error)
+            *error = reason;
+        return nullptr;
+    };
+
+    QFile& file = series->m_file;
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(file.errorString());
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(Header)))
+        return fail("Файл слишком короткий");
+
+    // Отображается весь файл, но в память подгружаются только прочитанные страницы
+    const uchar* map = file.map(0, fileSize);
+    if (!map)
+        return fail(file.errorString());
+
+    Header header;
+    std::memcpy(&header, map, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version)
+        return fail("Неизвестный формат файла");
+    if (header.byteOrder != ByteOrderMark)
+        return fail("Файл записан с другим порядком байт");
+    if (header.blockPoints == 0 || header.blockPoints > MaxBlockPoints ||
+        header.levelFactor < 2 || header.levelFactor > MaxLevelFactor || header.levelCount > MaxLevels)
+        return fail("Повреждённый заголовок");
+    // Размеры из заголовка проверяются до умножений: переполнение дало бы
+    // малый dataEnd, и точки отобразились бы за пределы файла. Второе
+    // условие не даёт переполниться levelSpan
+    if (header.count > quint64(fileSize - qint64(sizeof(Header))) / sizeof(QCPGraphData) ||
+        header.count > quint64(std::numeric_limits<qint64>::max()) / header.levelFactor ||
+        header.indexOffset > quint64(fileSize))
+        return fail("Повреждённый файл");
+
+    series->m_map = map;
+    series->m_count = qint64(header.count);
+    series->m_blockPoints = header.blockPoints;
+    series->m_levelFactor = header.levelFactor;
+
+    const qint64 dataEnd = qint64(sizeof(Header)) + series->m_count * qint64(sizeof(QCPGraphData));
+    if (dataEnd > qint64(header.indexOffset))
+        return fail("Повреждённый файл");
+    series->m_data = reinterpret_cast<const QCPGraphData*>(map + sizeof(Header));
+
+    // Уровни индекса идут подряд, пока не останется одна сводка
+    qint64 offset = qint64(header.indexOffset);
+    for (int level = 0; series->m_count > 0; ++level)
+    {
+        const qint64 count = series->levelSize(level);
+        if (offset + count * qint64(sizeof(Summary)) > fileSize)
+            return fail("Повреждённый индекс");
+        series->m_levels.append(reinterpret_cast<const Summary*>(map + offset));
+        offset += count * qint64(sizeof(Summary));
+        if (count == 1)
+            break;
+    }
+    if (series->m_levels.size() != int(header.levelCount))
+        return fail("Повреждённый индекс");
+
+    return series;
+}
+
+qint64 MappedSeries::levelSpan(int level) const
+{
+    // Сводка, покрывшая весь ряд, дальше не растёт: span < m_count, и
+    // произведение не переполняется (m_count * m_levelFactor проверено в open)
+    qint64 span = m_blockPoints;
+    for (int i = 0; i < level && span < m_count; ++i)
+        span *= m_levelFactor;
+    return span;
+}
+
+qint64 MappedSeries::levelSize(int level) const
+{
+    const qint64 span = levelSpan(level);
+    return (m_count + span - 1) / span;
+}
+
+qint64 MappedSeries::lowerBound(double key) const
+{
+    if (m_count == 0)
+        return 0;
+
+    // Первая корзина, где есть ключ не меньше key, затем поиск внутри неё
+    const Summary* blocks = m_levels[0];
+    const Summary* blocksEnd = blocks + levelSize(0);
+    const Summary* block = std::lower_bound(blocks, blocksEnd, key,
+                                            [](const Summary& s, double k) { return s.lastKey < k; });
+    if (block == blocksEnd)
+        return m_count;
+
+    const qint64 first = (block - blocks) * m_blockPoints;
+    const qint64 last = std::min(first + m_blockPoints, m_count);
+    return std::lower_bound(m_data + first, m_data + last, key,
+                            [](const QCPGraphData& d, double k) { return d.key < k; }) - m_data;
+}
+
+qint64 MappedSeries::upperBound(double key) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const Summary* blocks = m_levels[0];
+    const Summary* blocksEnd = blocks + levelSize(0);
+    const Summary* block = std::upper_bound(blocks, blocksEnd, key,
+                                            [](double k, const Summary& s) { return k < s.lastKey; });
+    if (block == blocksEnd)
+        return m_count;
+
+    const qint64 first = (block - blocks) * m_blockPoints;
+    const qint64 last = std::min(first + m_blockPoints, m_count);
+    return std::upper_bound(m_data + first, m_data + last, key,
+                            [](double k, const QCPGraphData& d) { return k < d.key; }) - m_data;
+}
+
+QCPRange MappedSeries::keyRange() const
+{
+    if (m_count == 0)
+        return QCPRange();
+    return QCPRange(m_data[0].key, m_data[m_count - 1].key);
+}
+
+QCPRange MappedSeries::valueRange(qint64 from, qint64 to, bool& found) const
+{
+    double minValue = NAN;
+    double maxValue = NAN;
+    collectRange(std::max<qint64>(from, 0), std::min(to, m_count), m_levels.size() - 1, minValue, maxValue);
+    found = !std::isnan(minValue);
+    return found ? QCPRange(minValue, maxValue) : QCPRange();
+}
+
+void MappedSeries::collectRange(qint64 from, qint64 to, int level, double& minValue, double& maxValue) const
+{
+    if (from >= to)
+        return;
+    if (level < 0)
+    {
+        for (qint64 i = from; i < to; ++i)
+        {
+            minValue = std::fmin(minValue, m_data[i].value);
+            maxValue = std::fmax(maxValue, m_data[i].value);
+        }
+        return;
+    }
+
+    // Целые сводки уровня (последняя может быть короче — она кончается
+    // вместе с файлом), края — по более мелким уровням
+    const qint64 span = levelSpan(level);
+    const qint64 first = (from + span - 1) / span;
+    const qint64 last = to == m_count ? levelSize(level) : to / span;
+    if (first >= last)
+    {
+        collectRange(from, to, level - 1, minValue, maxValue);
+        return;
+    }
+
+    collectRange(from, first * span, level - 1, minValue, maxValue);
+    const Summary* summaries = m_levels[level];
+    for (qint64 b = first; b < last; ++b)
+    {
+        minValue = std::fmin(minValue, summaries[b].minValue);
+        maxValue = std::fmax(maxValue, summaries[b].maxValue);
+    }
+    collectRange(std::min(last * span, to), to, level - 1, minValue, maxValue);
+}
+
+MappedSeriesWriter::MappedSeriesWriter(const QString& fileName)
+    : m_file(fileName)
+{
+}
+
+MappedSeriesWriter::~MappedSeriesWriter()
+{
+    if (m_file.isOpen())
+        close();
+}
+
+bool MappedSeriesWriter::open()
+{
+    m_count = 0;
+    m_buffer.clear();
+    m_summaries.clear();
+    m_ok = m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!m_ok)
+        return false;
+
+    // Заголовок дописывается в close(), когда известны размеры
+    const MappedSeries::Header header = {};
+    m_ok = m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == qint64(sizeof(header));
+    return m_ok;
+}
+
+bool MappedSeriesWriter::append(double key, double value)
+{
+    if (!m_ok || std::isnan(key) || (m_count > 0 && key < m_lastKey))
+        return false;
+
+    if (m_count % BlockPoints == 0)
+        m_current = {key, key, value, value};
+    m_current.lastKey = key;
+    m_current.minValue = std::fmin(m_current.minValue, value);
+    m_current.maxValue = std::fmax(m_current.maxValue, value);
+
+    m_buffer.append(QCPGraphData(key, value));
+    m_lastKey = key;
+    ++m_count;
+    if (m_count % BlockPoints == 0)
+        m_summaries.append(m_current);
+
+    // Пишем крупными кусками
+    if (m_buffer.size() >= 64 * BlockPoints)
+        return flush();
+    return true;
+}
+
+bool MappedSeriesWriter::flush()
+{
+    const qint64 bytes = qint64(m_buffer.size()) * qint64(sizeof(QCPGraphData));
+    m_ok = m_ok && m_file.write(reinterpret_cast<const char*>(m_buffer.constData()), bytes) == bytes;
+    m_buffer.clear();
+    return m_ok;
+}
+
+bool MappedSeriesWriter::close()
+{
+    if (!m_file.isOpen())
+        return false;
+    if (m_count % BlockPoints != 0)
+        m_summaries.append(m_current);
+    flush();
+
+    MappedSeries::Header header = {};
+    std::memcpy(header.magic, MappedSeries::Magic, sizeof(header.magic));
+    header.version = MappedSeries::Version;
+    header.byteOrder = MappedSeries::ByteOrderMark;
+    header.count = quint64(m_count);
+    header.blockPoints = BlockPoints;
+    header.levelFactor = LevelFactor;
+    header.indexOffset = quint64(m_file.pos());
+
+    // Уровни индекса: каждый следующий сводит LevelFactor сводок предыдущего
+    QVector<MappedSeries::Summary> level = m_summaries;
+    while (m_ok && !level.isEmpty())
+    {
+        const qint64 bytes = qint64(level.size()) * qint64(sizeof(MappedSeries::Summary));
+        m_ok = m_file.write(reinterpret_cast<const char*>(level.constData()), bytes) == bytes;
+        ++header.levelCount;
+        if (level.size() == 1)
+            break;
+
+        QVector<MappedSeries::Summary> next;
+        next.reserve((level.size() + LevelFactor - 1) / LevelFactor);
+        for (int i = 0; i < level.size(); i += LevelFactor)
+        {
+            MappedSeries::Summary summary = level[i];
+            for (int k = i + 1; k < std::min(i + LevelFactor, int(level.size())); ++k)
+                summary = merge(summary, level[k]);
+            next.append(summary);
+        }
+        level.swap(next);
+    }
+
+    m_ok = m_ok && m_file.seek(0) &&
+           m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == qint64(sizeof(header));
+    m_file.close();
+    return m_ok;
+}
+
+MappedSeries::Summary MappedSeriesWriter::merge(const MappedSeries::Summary& a, const MappedSeries::Summary& b)
+{
+    return {a.firstKey, b.lastKey, std::fmin(a.minValue, b.minValue), std::fmax(a.maxValue, b.maxValue)};
+}
@@ -0,0 +1,116 @@
+#ifndef MAPPEDSERIES_H
+#define MAPPEDSERIES_H
+
+#include "qcustomplot.h"
+#include <QFile>
+#include <memory>
+
+// Двоичный файл ряда отсчётов, который читается через отображение в память
+// без копирования и сортировки. Формат (порядок байт записавшей машины):
+//   заголовок, 64 байта (Header);
+//   count пар double (key, value) с неубывающими ключами;
+//   индекс — уровни сводок (Summary). Сводка уровня L покрывает
+//   blockPoints * levelFactor^L подряд идущих точек, последний уровень — одна сводка.
+// Поиск по ключу идёт по сводкам нижнего уровня и затрагивает лишь несколько
+// страниц файла; в памяти оказываются только просмотренные участки
+class MappedSeries
+{
+public:
+    struct Summary {
+        double firstKey;
+        double lastKey;
+        // NaN не учитываются; у корзины из одних NaN оба значения — NaN
+        double minValue;
+        double maxValue;
+    };
+
+    // nullptr — файл не открылся или не является файлом ряда; причина — в error
+    static std::shared_ptr<const MappedSeries> open(const QString& fileName, QString* error = nullptr);
+
+    qint64 size() const { return m_count; }
+    // Точки файла без копирования: пара double совпадает по раскладке с QCPGraphData
+    const QCPGraphData* data() const { return m_data; }
+
+    int levelCount() const { return m_levels.size(); }
+    // Число точек в сводке уровня
+    qint64 levelSpan(int level) const;
+    qint64 levelSize(int level) const;
+    const Summary* level(int level) const { return m_levels[level]; }
+
+    // Индекс первой точки с ключом не меньше key (size(), если таких нет)
+    qint64 lowerBound(double key) const;
+    // Индекс первой точки с ключом больше key
+    qint64 upperBound(double key) const;
+
+    QCPRange keyRange() const;
+    // Диапазон значений точек from..to-1 по сводкам, без обхода всех точек;
+    // found = false, если там только NaN
+    QCPRange valueRange(qint64 from, qint64 to, bool& found) const;
+
+    static const char Magic[8];
+    static const quint32 Version = 1;
+    static const quint32 ByteOrderMark = 0x01020304;
+
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 byteOrder;
+        quint64 count;
+        quint32 blockPoints;
+        quint32 levelFactor;
+        quint32 levelCount;
+        quint32 reserved32;
+        quint64 indexOffset;
+        quint64 reserved[2];
+    };
+
+private:
+    // Пределы полей заголовка: большие значения — признак повреждения
+    static const quint32 MaxBlockPoints = 1 << 24;
+    static const quint32 MaxLevelFactor = 1 << 16;
+    static const quint32 MaxLevels = 64;
+
+    MappedSeries() {}
+
+    void collectRange(qint64 from, qint64 to, int level, double& minValue, double& maxValue) const;
+
+    QFile m_file;
+    const uchar* m_map = nullptr;
+    const QCPGraphData* m_data = nullptr;
+    qint64 m_count = 0;
+    qint64 m_blockPoints = 0;
+    qint64 m_levelFactor = 0;
+    QVector<const Summary*> m_levels;
+};
+
+// Запись файла ряда потоком: точки пишутся по мере поступления,
+// индекс и заголовок — в close()
+class MappedSeriesWriter
+{
+public:
+    explicit MappedSeriesWriter(const QString& fileName);
+    ~MappedSeriesWriter();
+
+    bool open();
+    // false — ключ меньше предыдущего или ошибка записи
+    bool append(double key, double value);
+    bool close();
+
+    // Точек в сводке нижнего уровня и во сколько раз растёт сводка с уровнем
+    static const int BlockPoints = 1024;
+    static const int LevelFactor = 16;
+
+private:
+    bool flush();
+    static MappedSeries::Summary merge(const MappedSeries::Summary& a, const MappedSeries::Summary& b);
+
+    QFile m_file;
+    QVector<QCPGraphData> m_buffer;
+    QVector<MappedSeries::Summary> m_summaries;
+    MappedSeries::Summary m_current;
+    qint64 m_count = 0;
+    double m_lastKey = 0.0;
+    bool m_ok = false;
+};
+
+#endif // MAPPEDSERIES_H
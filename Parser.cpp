@@ -1,292 +1,256 @@
 #include "Parser.h"
+#include "CompiledFunction.h"
+#include <algorithm>
 #include <cmath>
 
-Function* PolynomialParser::parse(const QString& input) {
-    QVector<double> coefficients = parseCoefficients(input);
-    if (coefficients.isEmpty()) {
+Function* ExpressionParser::parse(const QString& input) {
+    ExprPtr root = ExpressionReader::read(input);
+    if (!root) {
         return nullptr;
     }
-    return new PolynomialFunction(coefficients);
-}
-
-QVector<double> PolynomialParser::parseCoefficients(const QString& input) {
-    QString line = input;
-    line.remove(' ');
+    root = ExpressionSimplifier::simplify(std::move(root));
 
-    QRegularExpression validCharsRegex(R"(^[0-9xX+\-*/^.\s/]+$)");
-    if (!validCharsRegex.match(line).hasMatch()) {
-        return {};
+    Function* func = lowerToTemplate(*root);
+    if (func) {
+        return func;
     }
+    return new CompiledFunction(*root);
+}
 
-    QRegularExpression re(R"(([+-]?)(\d+(?:/\d+)?|\d*\.?\d*)\*?x?(\^(\d+))?)");
-    QRegularExpressionMatchIterator i = re.globalMatch(line);
-
-    int maxDegree = 0;
-    QVector<std::pair<int, double>> terms;
-    bool foundTerm = false;
-
-    while (i.hasNext()) {
-        QRegularExpressionMatch match = i.next();
-
-        if (match.captured(0).isEmpty()) continue;
-
-        foundTerm = true;
-
-        QString signStr = match.captured(1);
-        QString coeffStr = match.captured(2);
-        QString powerStr = match.captured(4);
-
-        double sign = (signStr == "-") ? -1.0 : 1.0;
-        bool hasX = match.captured(0).contains('x');
-        double coeff = 0.0;
-
-        if (coeffStr.isEmpty()) {
-            coeff = hasX ? 1.0 : 0.0;
-        } else {
-            if (coeffStr.contains('/')) {
-                QStringList parts = coeffStr.split('/');
-                if (parts.size() == 2) {
-                    bool ok1, ok2;
-                    double numerator = parts[0].toDouble(&ok1);
-                    double denominator = parts[1].toDouble(&ok2);
-                    if (ok1 && ok2 && denominator != 0)
-                        coeff = numerator / denominator;
-                    else
-                        return {};
-                } else {
-                    return {};
-                }
-            } else {
-                bool okCoeff = false;
-                coeff = coeffStr.toDouble(&okCoeff);
-                if (!okCoeff) {
-                    return {};
-                }
-            }
-        }
+// Число ненулевых слагаемых многочлена
+static int termCount(const QVector<double>& coeffs) {
+    return int(std::count_if(coeffs.begin(), coeffs.end(), [](double c) { return c != 0.0; }));
+}
 
-        coeff *= sign;
-        int power = 0;
-        if (hasX) {
-            bool okPower = false;
-            power = powerStr.isEmpty() ? 1 : powerStr.toInt(&okPower);
-            if (!okPower && !powerStr.isEmpty()) {
-                return {};
-            }
+// Коэффициенты многочлена от x, если поддерево им является. Произведение
+// многочленов раскрывается, только если один множитель — одночлен (каждый
+// коэффициент результата — одно произведение) или степень результата не
+// больше MaxExpandedDegree: иначе суммы больших коэффициентов разных знаков
+// теряют точность, и (x-3)^30 у x = 3 считается с ошибкой ~1e6. Такие
+// выражения вычисляет CompiledFunction как записаны
+bool ExpressionParser::polynomialOf(const ExprNode& node, QVector<double>& coeffs) {
+    if (node.isConstant()) {
+        double v = node.evaluate(0.0);
+        if (!std::isfinite(v)) {
+            return false;
         }
-
-        if (power > maxDegree)
-            maxDegree = power;
-
-        terms.append({power, coeff});
+        coeffs = {v};
+        return true;
     }
 
-    if (!foundTerm) {
-        return {};
+    QVector<double> l, r;
+    switch (node.type) {
+    case ExprNode::Variable:
+        coeffs = {0.0, 1.0};
+        return true;
+    case ExprNode::Negate:
+        if (!polynomialOf(*node.left, coeffs)) return false;
+        for (double& c : coeffs) c = -c;
+        return true;
+    case ExprNode::Add:
+    case ExprNode::Sub: {
+        if (!polynomialOf(*node.left, l) || !polynomialOf(*node.right, r)) return false;
+        const double sign = node.type == ExprNode::Add ? 1.0 : -1.0;
+        coeffs = QVector<double>(std::max(l.size(), r.size()), 0.0);
+        for (int i = 0; i < l.size(); ++i) coeffs[i] += l[i];
+        for (int i = 0; i < r.size(); ++i) coeffs[i] += sign * r[i];
+        return true;
     }
-
-    QVector<double> coefs(maxDegree + 1, 0.0);
-    for (auto& term : terms) {
-        coefs[term.first] += term.second;
+    case ExprNode::Mul: {
+        if (!polynomialOf(*node.left, l) || !polynomialOf(*node.right, r)) return false;
+        if (l.size() + r.size() - 2 > MaxPolynomialDegree) return false;
+        if (termCount(l) > 1 && termCount(r) > 1 && l.size() + r.size() - 2 > MaxExpandedDegree) return false;
+        coeffs = QVector<double>(l.size() + r.size() - 1, 0.0);
+        for (int i = 0; i < l.size(); ++i)
+            for (int j = 0; j < r.size(); ++j)
+                coeffs[i + j] += l[i] * r[j];
+        return true;
+    }
+    case ExprNode::Div: {
+        if (!node.right->isConstant()) return false;
+        double divisor = node.right->evaluate(0.0);
+        if (divisor == 0.0 || !std::isfinite(divisor)) return false;
+        if (!polynomialOf(*node.left, coeffs)) return false;
+        for (double& c : coeffs) c /= divisor;
+        return true;
+    }
+    case ExprNode::Pow: {
+        if (!node.right->isConstant()) return false;
+        double exponent = node.right->evaluate(0.0);
+        if (exponent < 0 || exponent != std::floor(exponent) || exponent > MaxPolynomialDegree) return false;
+        if (!polynomialOf(*node.left, l)) return false;
+        const int power = static_cast<int>(exponent);
+        if ((l.size() - 1) * power > MaxPolynomialDegree) return false;
+        if (termCount(l) > 1 && power > 1 && (l.size() - 1) * power > MaxExpandedDegree) return false;
+        coeffs = {1.0};
+        for (int k = 0; k < power; ++k) {
+            QVector<double> product(coeffs.size() + l.size() - 1, 0.0);
+            for (int i = 0; i < coeffs.size(); ++i)
+                for (int j = 0; j < l.size(); ++j)
+                    product[i + j] += coeffs[i] * l[j];
+            coeffs = product;
+        }
+        return true;
+    }
+    default:
+        return false;
     }
-
-    return coefs;
 }
 
-Function* TrigonometricParser::parse(const QString& input) {
-    QString str = input.simplified().replace(" ", "");
-
-    QRegularExpression re(R"(^([+-]?(?:\d+\.?\d*|\.\d+)?)\*?(sin|cos|tan|cot)\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]?\d*\.?\d*)?\)([+-]?\d*\.?\d*)?$)");
-    QRegularExpressionMatch match = re.match(str);
-
-    if (!match.hasMatch()) {
-        re.setPattern(R"(^([+-])?(sin|cos|tan|cot)\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]?\d*\.?\d*)?\)([+-]?\d*\.?\d*)?$)");
-        match = re.match(str);
-        if (!match.hasMatch()) {
-            re.setPattern(R"(^([+-]?(?:\d+\.?\d*|\.\d+)?)\*?(sin|cos|tan|cot)\(-x\)([+-]?\d*\.?\d*)?$)");
-            match = re.match(str);
-            if (!match.hasMatch()) {
-                re.setPattern(R"(^([+-])?(sin|cos|tan|cot)\(-x\)([+-]?\d*\.?\d*)?$)");
-                match = re.match(str);
-                if (!match.hasMatch()) {
-                    return nullptr;
-                }
-            }
+// Распознаёт многочлен и выражения вида scale * f(k*x + m) + offset
+Function* ExpressionParser::lowerToTemplate(const ExprNode& root) {
+    QVector<double> coeffs;
+    if (polynomialOf(root, coeffs)) {
+        while (coeffs.size() > 1 && coeffs.last() == 0.0) {
+            coeffs.removeLast();
         }
+        return new PolynomialFunction(coeffs);
     }
 
-    TrigonometricFunction::Type type;
-    QString funcType = match.captured(2);
-    if (funcType == "sin") type = TrigonometricFunction::Sin;
-    else if (funcType == "cos") type = TrigonometricFunction::Cos;
-    else if (funcType == "tan") type = TrigonometricFunction::Tan;
-    else if (funcType == "cot") type = TrigonometricFunction::Cot;
-    else return nullptr;
-
-    double a = 1.0;
-    if (match.captured(1) == "-") {
-        a = -1.0;
-    } else if (!match.captured(1).isEmpty() && match.captured(1) != "+") {
-        a = match.captured(1).toDouble();
+    // Снимаем внешние сложения и умножения на константы
+    double scale = 1.0;
+    double offset = 0.0;
+    const ExprNode* core = &root;
+    for (;;) {
+        const ExprNode* l = core->left.get();
+        const ExprNode* r = core->right.get();
+        if (core->type == ExprNode::Add && l->isConstant()) {
+            offset += scale * l->evaluate(0.0);
+            core = r;
+        } else if (core->type == ExprNode::Add && r->isConstant()) {
+            offset += scale * r->evaluate(0.0);
+            core = l;
+        } else if (core->type == ExprNode::Sub && r->isConstant()) {
+            offset -= scale * r->evaluate(0.0);
+            core = l;
+        } else if (core->type == ExprNode::Sub && l->isConstant()) {
+            offset += scale * l->evaluate(0.0);
+            scale = -scale;
+            core = r;
+        } else if (core->type == ExprNode::Mul && l->isConstant()) {
+            scale *= l->evaluate(0.0);
+            core = r;
+        } else if (core->type == ExprNode::Mul && r->isConstant()) {
+            scale *= r->evaluate(0.0);
+            core = l;
+        } else if (core->type == ExprNode::Div && r->isConstant()) {
+            scale /= r->evaluate(0.0);
+            core = l;
+        } else if (core->type == ExprNode::Negate) {
+            scale = -scale;
+            core = l;
+        } else {
+            break;
+        }
     }
 
-    double b = 1.0;
-    double c = 0.0;
-
-    if (match.captured(0).contains("(-x)")) {
-        b = -1.0;
-    } else {
-        b = match.captured(3).isEmpty() ? 1.0 : match.captured(3).toDouble();
-        c = match.captured(4).isEmpty() ? 0.0 : match.captured(4).toDouble();
+    if (core->type != ExprNode::Call || !std::isfinite(scale) || !std::isfinite(offset)) {
+        return nullptr;
     }
 
-    double d = match.captured(match.capturedTexts().size() - 1).isEmpty() ? 0.0 : match.captured(match.capturedTexts().size() - 1).toDouble();
-
-    TrigonometricFunction* func = new TrigonometricFunction(type);
-    func->setCoefficients({d, a, b, c});
-    return func;
-}
-
-Function* ExponentialParser::parse(const QString& input) {
-    QString str = input.simplified().replace(" ", "");
-
-    QRegularExpression re(R"(^([+-]?(?:\d+\.?\d*|\.\d+)?)\*?exp\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]\d+\.?\d*)?\)([+-]\d+\.?\d*)?$)");
-    QRegularExpressionMatch match = re.match(str);
-
-    if (!match.hasMatch()) {
-        re.setPattern(R"(^([+-])?exp\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]\d+\.?\d*)?\)([+-]\d+\.?\d*)?$)");
-        match = re.match(str);
-        if (!match.hasMatch()) {
-            return nullptr;
+    // Аргумент функции должен быть линейным: k*x + m
+    if (!polynomialOf(*core->left, coeffs) || coeffs.size() > 2) {
+        return nullptr;
+    }
+    const double m = coeffs.value(0, 0.0);
+    const double k = coeffs.value(1, 0.0);
+
+    switch (core->func) {
+    case ExprNode::Sin:
+    case ExprNode::Cos:
+    case ExprNode::Tan:
+    case ExprNode::Cot: {
+        TrigonometricFunction::Type type =
+            core->func == ExprNode::Sin ? TrigonometricFunction::Sin :
+            core->func == ExprNode::Cos ? TrigonometricFunction::Cos :
+            core->func == ExprNode::Tan ? TrigonometricFunction::Tan : TrigonometricFunction::Cot;
+        TrigonometricFunction* func = new TrigonometricFunction(type);
+        func->setCoefficients({offset, scale, k, m});
+        return func;
+    }
+    case ExprNode::Exp: {
+        ExponentialFunction* func = new ExponentialFunction();
+        func->setCoefficients({offset, scale, k, m});
+        return func;
+    }
+    case ExprNode::Ln:
+    case ExprNode::Log: {
+        double base = M_E;
+        if (core->func == ExprNode::Log) {
+            if (!core->right->isConstant()) return nullptr;
+            base = core->right->evaluate(0.0);
+            if (!(base > 0.0) || base == 1.0 || !std::isfinite(base)) return nullptr;
         }
+        LogarithmicFunction* func = new LogarithmicFunction();
+        func->setCoefficients({scale, base, k, m, offset});
+        return func;
     }
-
-    double a = 1.0;
-    if (match.captured(1) == "-") {
-        a = -1.0;
-    } else if (!match.captured(1).isEmpty() && match.captured(1) != "+") {
-        a = match.captured(1).toDouble();
+    case ExprNode::Abs: {
+        ModulusFunction* func = new ModulusFunction();
+        func->setCoefficients({m, offset, k, scale});
+        return func;
     }
+    default:
+        return nullptr;
+    }
+}
 
-    QString cap = match.captured(2);
-    double b = (cap == "-") ? -1.0 : (cap.isEmpty() ? 1.0 : cap.toDouble());
-    double c = match.captured(3).isEmpty() ? 0.0 : match.captured(3).toDouble();
-    double d = match.captured(4).isEmpty() ? 0.0 : match.captured(4).toDouble();
-
-    ExponentialFunction* func = new ExponentialFunction();
-    func->setCoefficients({d, a, b, c});
-    return func;
+ParserCache::ParserCache(int capacity) {
+    m_cache.setMaxCost(capacity);
 }
 
-Function* LogarithmicParser::parse(const QString& input) {
-    QString str = input.simplified().replace(" ", "");
+ParserCache& ParserCache::instance() {
+    static ParserCache cache;
+    return cache;
+}
 
-    QRegularExpression re(R"(^([+-]?(?:\d+\.?\d*|\.\d+)?)\*?log_(\d+\.?\d*|\(\d+/\d+\))\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]\d+\.?\d*)?\)([+-]\d+\.?\d*)?$)");
-    QRegularExpressionMatch match = re.match(str);
+QString ParserCache::normalize(const QString& input) {
+    // Пробел разделяет лексемы ("2 3" — не "23"), поэтому не удаляется,
+    // а только сводится к одному
+    return input.simplified().toLower();
+}
 
-    if (!match.hasMatch()) {
-        re.setPattern(R"(^([+-]?(?:\d+\.?\d*|\.\d+)?)\*?ln\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]\d+\.?\d*)?\)([+-]\d+\.?\d*)?$)");
-        match = re.match(str);
-        if (!match.hasMatch()) {
-            re.setPattern(R"(^([+-]?(?:\d+\.?\d*|\.\d+)?)\*?log\(([+-]?(?:\d+\.?\d*|\.\d+)?)\*?x([+-]\d+\.?\d*)?\)([+-]\d+\.?\d*)?$)");
-            match = re.match(str);
-            if (!match.hasMatch()) {
-                return nullptr;
-            }
+std::shared_ptr<const Function> ParserCache::parse(const QString& input) {
+    const QString key = normalize(input);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (std::shared_ptr<const Function>* cached = m_cache.object(key)) {
+            ++m_hits;
+            return *cached;
         }
+        ++m_misses;
     }
 
-    double a = 1.0;
-    if (match.captured(1) == "-") {
-        a = -1.0;
-    } else if (!match.captured(1).isEmpty() && match.captured(1) != "+") {
-        a = match.captured(1).toDouble();
-    }
-
-    double base = 10.0;
-    if (re.pattern().contains("log_")) {
-        base = evalExpression(match.captured(2));
-    } else if (re.pattern().contains("ln")) {
-        base = M_E;
+    // Разбор вне блокировки: он может быть долгим. Разбирается сам ввод,
+    // ключ нужен только для поиска
+    std::shared_ptr<const Function> func(ParserFactory::createParser(input)->parse(input));
+    if (!func) {
+        return nullptr;
     }
 
-    QString cap = match.captured(re.pattern().contains("ln") ? 2 : 3);
-    double c = (cap == "-") ? -1.0 : (cap.isEmpty() ? 1.0 : cap.toDouble());
-    double d = match.captured(re.pattern().contains("ln") ? 3 : 4).isEmpty() ? 0.0 : match.captured(re.pattern().contains("ln") ? 3 : 4).toDouble();
-    double e = match.captured(re.pattern().contains("ln") ? 4 : 5).isEmpty() ? 0.0 : match.captured(re.pattern().contains("ln") ? 4 : 5).toDouble();
-
-    LogarithmicFunction* func = new LogarithmicFunction();
-    func->setCoefficients({a, base, c, d, e});
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(key, new std::shared_ptr<const Function>(func));
     return func;
 }
 
-double LogarithmicParser::evalExpression(const QString& expr) {
-    if (expr.startsWith('(') && expr.endsWith(')')) {
-        QString inner = expr.mid(1, expr.length() - 2);
-        if (inner.contains('/')) {
-            QStringList parts = inner.split('/');
-            if (parts.size() == 2) {
-                double num = parts[0].toDouble();
-                double den = parts[1].toDouble();
-                return den != 0 ? num / den : 1.0;
-            }
-        }
-    }
-    return expr.toDouble();
+int ParserCache::hits() const {
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
 }
 
-Function* ModulusParser::parse(const QString& input) {
-    QString str = input.simplified().replace(" ", "");
-
-    QRegularExpression dExpr(R"(([+-]\d+(\.\d+)?)$)");
-    QRegularExpressionMatch dMatch = dExpr.match(str);
-
-    double d = 0.0;
-    if (dMatch.hasMatch()) {
-        QString dStr = dMatch.captured(1);
-        d = dStr.toDouble();
-        str.chop(dStr.length());
-    }
-
-    double c = 1.0;
-    QRegularExpression cExpr(R"(^([+-]?\d*\.?\d*)\*?\|)");
-    QRegularExpressionMatch cMatch = cExpr.match(str);
-    if (cMatch.hasMatch()) {
-        QString cStr = cMatch.captured(1);
-        if (!cStr.isEmpty() && cStr != "+" && cStr != "-")
-            c = cStr.toDouble();
-        else if (cStr == "-")
-            c = -1.0;
-        int pos = cMatch.capturedLength();
-        str = str.mid(pos - 1);
-    }
-
-    QRegularExpression insideExpr(R"(\|([+-]?\d*\.?\d*)\*?x([+-]\d+(\.\d+)?)?\|)");
-    QRegularExpressionMatch insideMatch = insideExpr.match(str);
-    double a = 1.0;
-    double b = 0.0;
-    if (insideMatch.hasMatch()) {
-        QString aStr = insideMatch.captured(1);
-        QString bStr = insideMatch.captured(2);
-
-        if (!aStr.isEmpty() && aStr != "+" && aStr != "-")
-            a = aStr.toDouble();
-        else if (aStr == "-")
-            a = -1.0;
+int ParserCache::misses() const {
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
 
-        if (!bStr.isEmpty())
-            b = bStr.toDouble();
-    }
-    else {
-        if (str == "|x|")
-            a = 1.0, b = 0.0;
-        else if (str == "|-x|")
-            a = -1.0, b = 0.0;
-        else
-            return nullptr;
-    }
+int ParserCache::size() const {
+    QMutexLocker locker(&m_mutex);
+    return m_cache.size();
+}
 
-    ModulusFunction* func = new ModulusFunction();
-    func->setCoefficients({b, d, a, c});
-    return func;
+void ParserCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+    m_hits = 0;
+    m_misses = 0;
 }
@@ -3,9 +3,11 @@
 
 #include <QString>
 #include <QVector>
-#include <QRegularExpression>
+#include <QCache>
+#include <QMutex>
 #include <memory>
 #include "Function.h"
+#include "Expression.h"
 
 // Базовый класс парсера
 class Parser {
@@ -14,52 +16,62 @@ public:
     virtual Function* parse(const QString& input) = 0;
 };
 
-class PolynomialParser : public Parser {
+// Разбор произвольного выражения через синтаксическое дерево.
+// Выражения шаблонного вида (многочлен, a*sin(b*x+c)+d, a*exp(b*x+c)+d,
+// a*log_b(c*x+d)+e, c*|a*x+b|+d) превращаются в соответствующие классы
+// функций, все остальные компилируются в байт-код (CompiledFunction).
+class ExpressionParser : public Parser {
 public:
     Function* parse(const QString& input) override;
-    static QVector<double> parseCoefficients(const QString& input);
-};
 
-class TrigonometricParser : public Parser {
-public:
-    Function* parse(const QString& input) override;
-};
+    // Наибольшая степень многочлена, которую распознаёт parse
+    static const int MaxPolynomialDegree = 64;
+    // Наибольшая степень, до которой раскрываются произведения и степени
+    // многочленов из нескольких слагаемых
+    static const int MaxExpandedDegree = 4;
 
-class ExponentialParser : public Parser {
-public:
-    Function* parse(const QString& input) override;
-};
-
-class LogarithmicParser : public Parser {
-public:
-    Function* parse(const QString& input) override;
 private:
-    static double evalExpression(const QString& expr);
-};
-
-class ModulusParser : public Parser {
-public:
-    Function* parse(const QString& input) override;
+    static Function* lowerToTemplate(const ExprNode& root);
+    static bool polynomialOf(const ExprNode& node, QVector<double>& coeffs);
 };
 
 // Фабрика парсеров
 class ParserFactory {
 public:
     static std::unique_ptr<Parser> createParser(const QString& functionType) {
-        if (functionType.contains("sin") || functionType.contains("cos") ||
-            functionType.contains("tan") || functionType.contains("cot")) {
-            return std::make_unique<TrigonometricParser>();
-        } else if (functionType.contains("exp")) {
-            return std::make_unique<ExponentialParser>();
-        } else if (functionType.contains("log") || functionType.contains("ln")) {
-            return std::make_unique<LogarithmicParser>();
-        } else if (functionType.contains('|')) {
-            return std::make_unique<ModulusParser>();
-        } else {
-            // По умолчанию пробуем парсить как полином
-            return std::make_unique<PolynomialParser>();
-        }
+        // Шаблонные функции распознаются по дереву выражения,
+        // поэтому один парсер подходит для любого ввода
+        Q_UNUSED(functionType);
+        return std::make_unique<ExpressionParser>();
     }
 };
 
+// LRU-кэш разбора: нормализованный текст выражения -> неизменяемая функция.
+// Функцию разделяют графики и задания построения, поэтому повторный ввод
+// не разбирает и не компилирует выражение заново. Потокобезопасен
+class ParserCache {
+public:
+    explicit ParserCache(int capacity = 256);
+
+    // Общий кэш приложения
+    static ParserCache& instance();
+
+    // nullptr, если выражение некорректно; ошибки не кэшируются
+    std::shared_ptr<const Function> parse(const QString& input);
+    // Ключ кэша: в нижнем регистре (разбору он не важен), пробелы по краям
+    // убраны, подряд идущие сведены к одному
+    static QString normalize(const QString& input);
+
+    int hits() const;
+    int misses() const;
+    int size() const;
+    void clear();
+
+private:
+    QCache<QString, std::shared_ptr<const Function>> m_cache;
+    mutable QMutex m_mutex;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
 #endif // PARSER_H
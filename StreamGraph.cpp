@@ -0,0 +1,172 @@
+#include "StreamGraph.h"
+#include <algorithm>
+
+// Подставляет кусок на место контейнера и пирамиды графика, пока работают
+// методы QCPGraph и DecimatedGraph. Обмен указателями, без копирования точек
+class StreamGraph::ChunkScope
+{
+public:
+    ChunkScope(const StreamGraph* graph, const Chunk& chunk)
+        : m_graph(const_cast<StreamGraph*>(graph)), m_chunk(const_cast<Chunk&>(chunk))
+    {
+        swap();
+    }
+
+    ~ChunkScope()
+    {
+        swap();
+    }
+
+private:
+    void swap()
+    {
+        m_graph->mDataContainer.swap(m_chunk.data);
+        std::swap(m_graph->m_pyramid, m_chunk.pyramid);
+    }
+
+    StreamGraph* m_graph;
+    Chunk& m_chunk;
+};
+
+StreamGraph::StreamGraph(QCPAxis* keyAxis, QCPAxis* valueAxis)
+    : DecimatedGraph(keyAxis, valueAxis)
+{
+    // Индексы выбранных точек относились бы к одному куску
+    setSelectable(QCP::stWhole);
+}
+
+void StreamGraph::append(const QVector<QCPGraphData>& points)
+{
+    int offset = 0;
+    while (offset < points.size())
+    {
+        if (m_chunks.isEmpty() || m_tailPoints == ChunkPoints)
+        {
+            // Память куска выделяется сразу и не сжимается: точки в нём не переезжают
+            Chunk chunk;
+            chunk.data = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
+            chunk.data->setAutoSqueeze(false);
+            chunk.data->reserve(ChunkPoints);
+            // Подгонка осей по значениям окна — за O(log n) по индексу контейнера
+            chunk.data->setValueRangeIndex(true);
+            m_tailPoints = 0;
+            // Кусок начинается с последней точки предыдущего, чтобы линия не рвалась
+            if (!isEmpty())
+            {
+                chunk.data->add(*(m_chunks.last().data->constEnd() - 1));
+                m_tailPoints = 1;
+            }
+            m_chunks.append(chunk);
+        }
+
+        const int count = std::min(int(points.size()) - offset, ChunkPoints - m_tailPoints);
+        m_chunks.last().data->add(count == points.size() ? points : points.mid(offset, count), true);
+        m_tailPoints += count;
+        offset += count;
+    }
+}
+
+void StreamGraph::removeBefore(double key)
+{
+    // Первая точка следующего куска совпадает с последней точкой этого,
+    // поэтому кусок, целиком ушедший из окна, можно просто отбросить
+    while (m_chunks.size() > 1 && (m_chunks.first().data->isEmpty() ||
+                                   (m_chunks.first().data->constEnd() - 1)->key < key))
+        m_chunks.removeFirst();
+    if (!m_chunks.isEmpty())
+    {
+        ChunkScope scope(this, m_chunks.first());
+        DecimatedGraph::removeBefore(key);
+    }
+}
+
+bool StreamGraph::isEmpty() const
+{
+    // Пустым может остаться только единственный кусок
+    return m_chunks.isEmpty() || m_chunks.last().data->isEmpty();
+}
+
+double StreamGraph::lastKey() const
+{
+    return (m_chunks.last().data->constEnd() - 1)->key;
+}
+
+double StreamGraph::selectTest(const QPointF& pos, bool onlySelectable, QVariant* details) const
+{
+    // Расстояние до ближайшего куска; при выборе целиком индекс точки не важен
+    double result = -1;
+    for (const Chunk& chunk : m_chunks)
+    {
+        if (!isInView(chunk))
+            continue;
+        ChunkScope scope(this, chunk);
+        QVariant chunkDetails;
+        const double distance = QCPGraph::selectTest(pos, onlySelectable, details ? &chunkDetails : nullptr);
+        if (distance >= 0 && (result < 0 || distance < result))
+        {
+            result = distance;
+            if (details)
+                *details = chunkDetails;
+        }
+    }
+    return result;
+}
+
+QCPRange StreamGraph::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    QCPRange range;
+    foundRange = false;
+    for (const Chunk& chunk : m_chunks)
+    {
+        bool found = false;
+        const QCPRange chunkRange = chunk.data->keyRange(found, inSignDomain);
+        if (!found)
+            continue;
+        if (foundRange)
+            range.expand(chunkRange);
+        else
+            range = chunkRange;
+        foundRange = true;
+    }
+    return range;
+}
+
+QCPRange StreamGraph::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    QCPRange range;
+    foundRange = false;
+    for (const Chunk& chunk : m_chunks)
+    {
+        bool found = false;
+        const QCPRange chunkRange = chunk.data->valueRange(found, inSignDomain, inKeyRange);
+        if (!found)
+            continue;
+        if (foundRange)
+            range.expand(chunkRange);
+        else
+            range = chunkRange;
+        foundRange = true;
+    }
+    return range;
+}
+
+void StreamGraph::draw(QCPPainter* painter)
+{
+    // Каждый видимый кусок рисуется как обычный график; соседние куски
+    // делят крайнюю точку, и линия между ними не рвётся
+    for (const Chunk& chunk : m_chunks)
+    {
+        if (!isInView(chunk))
+            continue;
+        ChunkScope scope(this, chunk);
+        QCPGraph::draw(painter);
+    }
+}
+
+bool StreamGraph::isInView(const Chunk& chunk) const
+{
+    if (chunk.data->isEmpty() || !mKeyAxis)
+        return false;
+    const QCPRange range = mKeyAxis.data()->range();
+    return chunk.data->constBegin()->key <= range.upper && (chunk.data->constEnd() - 1)->key >= range.lower;
+}
@@ -0,0 +1,55 @@
+#ifndef STREAMGRAPH_H
+#define STREAMGRAPH_H
+
+#include "DecimatedGraph.h"
+
+// График живого ряда. Точки хранятся кусками по ChunkPoints: память куска
+// выделяется сразу, поэтому дописывание не перевыделяет и не копирует ряд,
+// а старые куски удаляются целиком. У каждого куска своя пирамида min/max.
+// Для QCustomPlot это один график: отрисовка и выбор мышью по очереди
+// подставляют куски на место контейнера графика, выбирается весь ряд
+// (QCP::stWhole). data() остаётся пустым — точки доступны только через
+// методы ниже
+class StreamGraph : public DecimatedGraph
+{
+    Q_OBJECT
+
+public:
+    StreamGraph(QCPAxis* keyAxis, QCPAxis* valueAxis);
+
+    // Дописывает точки с ключами не меньше последнего
+    void append(const QVector<QCPGraphData>& points);
+    // Удаляет точки с ключом меньше key: куски, целиком ушедшие из окна,
+    // освобождаются, в первом оставшемся сдвигается начало
+    void removeBefore(double key);
+    bool isEmpty() const;
+    // Ключ последней точки; ряд не должен быть пуст
+    double lastKey() const;
+
+    double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = nullptr) const override;
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+
+private:
+    struct Chunk {
+        QSharedPointer<QCPGraphDataContainer> data;
+        Pyramid pyramid;
+    };
+    class ChunkScope;
+
+    // Точек в куске
+    static const int ChunkPoints = 1 << 17;
+
+    QList<Chunk> m_chunks;
+    // Сколько точек уже записано в последний кусок (с удалёнными из начала)
+    int m_tailPoints = 0;
+
+    // Задевает ли кусок видимый диапазон ключей
+    bool isInView(const Chunk& chunk) const;
+};
+
+#endif // STREAMGRAPH_H
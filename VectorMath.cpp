@@ -0,0 +1,265 @@
+#include "VectorMath.h"
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTORMATH_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Скалярная реализация: используется на платформах без SSE2, на x86 — по setActiveIsa(Scalar)
+namespace VectorMathScalar {
+
+template <double (*F)(double)>
+static void apply(const double* x, double* y, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        y[i] = F(x[i]);
+    }
+}
+
+static double sinOf(double x) { return std::sin(x); }
+static double cosOf(double x) { return std::cos(x); }
+static double tanOf(double x) { return std::tan(x); }
+static double expOf(double x) { return std::exp(x); }
+static double logOf(double x) { return std::log(x); }
+
+}
+
+#ifdef VECTORMATH_X86
+
+// SSE2: два double в регистре
+namespace VectorMathSse2 {
+
+typedef __m128d V;
+typedef __m128i I;
+enum { W = 2 };
+
+static inline V vset(double a) { return _mm_set1_pd(a); }
+static inline V vload(const double* p) { return _mm_loadu_pd(p); }
+static inline void vstore(double* p, V a) { _mm_storeu_pd(p, a); }
+static inline V vadd(V a, V b) { return _mm_add_pd(a, b); }
+static inline V vsub(V a, V b) { return _mm_sub_pd(a, b); }
+static inline V vmul(V a, V b) { return _mm_mul_pd(a, b); }
+static inline V vdiv(V a, V b) { return _mm_div_pd(a, b); }
+static inline V vfma(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+static inline V vand(V a, V b) { return _mm_and_pd(a, b); }
+static inline V vxor(V a, V b) { return _mm_xor_pd(a, b); }
+static inline V vabs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+static inline V vselect(V mask, V a, V b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+static inline V vcmple(V a, V b) { return _mm_cmple_pd(a, b); }
+static inline V vcmpge(V a, V b) { return _mm_cmpge_pd(a, b); }
+static inline V vcmpgt(V a, V b) { return _mm_cmpgt_pd(a, b); }
+static inline int vmovemask(V a) { return _mm_movemask_pd(a); }
+
+static inline I asInt(V a) { return _mm_castpd_si128(a); }
+static inline V asDouble(I a) { return _mm_castsi128_pd(a); }
+static inline I iset64(long long a) { return _mm_set1_epi64x(a); }
+static inline I iadd64(I a, I b) { return _mm_add_epi64(a, b); }
+static inline I iand(I a, I b) { return _mm_and_si128(a, b); }
+static inline I ior(I a, I b) { return _mm_or_si128(a, b); }
+static inline I isll(I a, int n) { return _mm_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline I isrl(I a, int n) { return _mm_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+
+// Полная маска по младшему биту каждого 64-битного элемента
+static inline V maskBit0(I a)
+{
+    I low = _mm_cmpeq_epi32(_mm_and_si128(a, _mm_set1_epi64x(1)), _mm_set1_epi64x(1));
+    return _mm_castsi128_pd(_mm_shuffle_epi32(low, _MM_SHUFFLE(2, 2, 0, 0)));
+}
+
+#include "VectorMathKernels.h"
+
+}
+
+// AVX2 + FMA: четыре double в регистре. Функции этого блока компилируются
+// с расширенным набором инструкций и вызываются только после проверки CPU.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+namespace VectorMathAvx2 {
+
+typedef __m256d V;
+typedef __m256i I;
+enum { W = 4 };
+
+static inline V vset(double a) { return _mm256_set1_pd(a); }
+static inline V vload(const double* p) { return _mm256_loadu_pd(p); }
+static inline void vstore(double* p, V a) { _mm256_storeu_pd(p, a); }
+static inline V vadd(V a, V b) { return _mm256_add_pd(a, b); }
+static inline V vsub(V a, V b) { return _mm256_sub_pd(a, b); }
+static inline V vmul(V a, V b) { return _mm256_mul_pd(a, b); }
+static inline V vdiv(V a, V b) { return _mm256_div_pd(a, b); }
+static inline V vfma(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+static inline V vand(V a, V b) { return _mm256_and_pd(a, b); }
+static inline V vxor(V a, V b) { return _mm256_xor_pd(a, b); }
+static inline V vabs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+static inline V vselect(V mask, V a, V b) { return _mm256_blendv_pd(b, a, mask); }
+static inline V vcmple(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+static inline V vcmpge(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+static inline V vcmpgt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+static inline int vmovemask(V a) { return _mm256_movemask_pd(a); }
+
+static inline I asInt(V a) { return _mm256_castpd_si256(a); }
+static inline V asDouble(I a) { return _mm256_castsi256_pd(a); }
+static inline I iset64(long long a) { return _mm256_set1_epi64x(a); }
+static inline I iadd64(I a, I b) { return _mm256_add_epi64(a, b); }
+static inline I iand(I a, I b) { return _mm256_and_si256(a, b); }
+static inline I ior(I a, I b) { return _mm256_or_si256(a, b); }
+static inline I isll(I a, int n) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline I isrl(I a, int n) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+
+// blendv смотрит только на знаковый бит, поэтому достаточно сдвига
+static inline V maskBit0(I a) { return _mm256_castsi256_pd(_mm256_slli_epi64(a, 63)); }
+
+#include "VectorMathKernels.h"
+
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// Проверка поддержки AVX2 и FMA процессором и операционной системой
+static bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+#endif // VECTORMATH_X86
+
+// Таблица ядер выбранного набора инструкций
+struct VectorMathTable {
+    VectorMath::Isa isa;
+    void (*sin)(const double*, double*, int);
+    void (*cos)(const double*, double*, int);
+    void (*tan)(const double*, double*, int);
+    void (*exp)(const double*, double*, int);
+    void (*log)(const double*, double*, int);
+};
+
+static const VectorMathTable& tableFor(VectorMath::Isa isa)
+{
+#ifdef VECTORMATH_X86
+    if (isa == VectorMath::Avx2) {
+        using namespace VectorMathAvx2;
+        static const VectorMathTable avx2 = { VectorMath::Avx2, apply<SinKernel>, apply<CosKernel>,
+                                              apply<TanKernel>, apply<ExpKernel>, apply<LogKernel> };
+        return avx2;
+    }
+    if (isa == VectorMath::Sse2) {
+        using namespace VectorMathSse2;
+        static const VectorMathTable sse2 = { VectorMath::Sse2, apply<SinKernel>, apply<CosKernel>,
+                                              apply<TanKernel>, apply<ExpKernel>, apply<LogKernel> };
+        return sse2;
+    }
+#endif
+    using namespace VectorMathScalar;
+    static const VectorMathTable scalar = { VectorMath::Scalar, apply<sinOf>, apply<cosOf>,
+                                            apply<tanOf>, apply<expOf>, apply<logOf> };
+    return scalar;
+}
+
+static VectorMath::Isa bestIsa()
+{
+#ifdef VECTORMATH_X86
+    return cpuHasAvx2() ? VectorMath::Avx2 : VectorMath::Sse2;
+#else
+    return VectorMath::Scalar;
+#endif
+}
+
+// Выбранная таблица: определяется при первом вызове, меняется setActiveIsa()
+static std::atomic<const VectorMathTable*>& activeTable()
+{
+    static std::atomic<const VectorMathTable*> t(&tableFor(bestIsa()));
+    return t;
+}
+
+static const VectorMathTable& table()
+{
+    return *activeTable().load(std::memory_order_relaxed);
+}
+
+VectorMath::Isa VectorMath::activeIsa()
+{
+    return table().isa;
+}
+
+bool VectorMath::isSupported(Isa isa)
+{
+    switch (isa) {
+    case Scalar:
+        return true;
+#ifdef VECTORMATH_X86
+    case Sse2:
+        return true;
+    case Avx2:
+        return cpuHasAvx2();
+#endif
+    default:
+        return false;
+    }
+}
+
+bool VectorMath::setActiveIsa(Isa isa)
+{
+    if (!isSupported(isa)) {
+        return false;
+    }
+    activeTable().store(&tableFor(isa), std::memory_order_relaxed);
+    return true;
+}
+
+void VectorMath::sin(const double* x, double* y, int n)
+{
+    table().sin(x, y, n);
+}
+
+void VectorMath::cos(const double* x, double* y, int n)
+{
+    table().cos(x, y, n);
+}
+
+void VectorMath::tan(const double* x, double* y, int n)
+{
+    table().tan(x, y, n);
+}
+
+void VectorMath::exp(const double* x, double* y, int n)
+{
+    table().exp(x, y, n);
+}
+
+void VectorMath::log(const double* x, double* y, int n)
+{
+    table().log(x, y, n);
+}
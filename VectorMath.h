@@ -0,0 +1,37 @@
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+// Векторные версии трансцендентных функций для пакетного вычисления.
+// Ядра реализованы для SSE2 и AVX2+FMA, набор инструкций выбирается один раз
+// во время выполнения. На других архитектурах используется скалярный libm.
+//
+// Границы погрешности (относительно точного результата):
+//   exp      — не более 1 ulp для |x| <= 708;
+//   log      — не более 1 ulp для нормализованных x > 0;
+//   sin, cos — не более 1 ulp для |x| <= 1e5;
+//   tan      — не более 2.5 ulp для |x| <= 1e5.
+// Оценки получены из разбора алгоритмов (fdlibm-многочлены, редукция
+// аргумента с запасом точности) и проверены сравнением с long double libm.
+// Аргументы вне этих диапазонов, а также NaN, бесконечности и
+// денормализованные числа обрабатываются скалярными std::exp/log/sin/cos/tan,
+// поэтому результат для них совпадает с libm.
+//
+// Входной и выходной массивы могут совпадать (вычисление на месте).
+class VectorMath {
+public:
+    enum Isa { Scalar, Sse2, Avx2 };
+
+    // По умолчанию — лучший набор, поддерживаемый процессором
+    static Isa activeIsa();
+    static bool isSupported(Isa isa);
+    // Переключение набора для проверок и замеров; false — набор не поддерживается
+    static bool setActiveIsa(Isa isa);
+
+    static void sin(const double* x, double* y, int n);
+    static void cos(const double* x, double* y, int n);
+    static void tan(const double* x, double* y, int n);
+    static void exp(const double* x, double* y, int n);
+    static void log(const double* x, double* y, int n);
+};
+
+#endif // VECTORMATH_H
@@ -0,0 +1,242 @@
+// Общие векторные ядра VectorMath.
+//
+// Файл намеренно не имеет защиты от повторного включения: VectorMath.cpp
+// включает его отдельно в пространство имён каждого набора инструкций
+// (SSE2, AVX2), предварительно определив там тип V (вектор double),
+// тип I (целочисленный вектор той же ширины), ширину W и примитивы
+// vset/vload/vstore/vadd/.../maskBit0.
+
+// Округление до ближайшего целого через сложение с 1.5*2^52.
+// В bits остаётся битовое представление суммы: его младшие разряды
+// содержат целое значение в дополнительном коде.
+static inline V roundToInt(V v, I& bits)
+{
+    const V magic = vset(6755399441055744.0);
+    V t = vadd(v, magic);
+    bits = asInt(t);
+    return vsub(t, magic);
+}
+
+// Маска полностью обработанного блока
+static const int FullMask = (1 << W) - 1;
+
+struct ExpKernel {
+    static inline int block(V x, V& y)
+    {
+        const V ln2Hi = vset(6.93147180369123816490e-01);
+        const V ln2Lo = vset(1.90821492927058770002e-10);
+
+        // x = n*ln2 + r, |r| <= ln2/2
+        I nBits;
+        V n = roundToInt(vmul(x, vset(1.44269504088896338700e+00)), nBits);
+        V r = vsub(vsub(x, vmul(n, ln2Hi)), vmul(n, ln2Lo));
+
+        // Ряд Тейлора до r^13 (остаточный член меньше 0.05 ulp):
+        // p = 1 + (r + r^2 * q(r)), старшие слагаемые складываются последними
+        V q = vset(1.0 / 6227020800.0);
+        q = vfma(q, r, vset(1.0 / 479001600.0));
+        q = vfma(q, r, vset(1.0 / 39916800.0));
+        q = vfma(q, r, vset(1.0 / 3628800.0));
+        q = vfma(q, r, vset(1.0 / 362880.0));
+        q = vfma(q, r, vset(1.0 / 40320.0));
+        q = vfma(q, r, vset(1.0 / 5040.0));
+        q = vfma(q, r, vset(1.0 / 720.0));
+        q = vfma(q, r, vset(1.0 / 120.0));
+        q = vfma(q, r, vset(1.0 / 24.0));
+        q = vfma(q, r, vset(1.0 / 6.0));
+        q = vfma(q, r, vset(0.5));
+        V p = vadd(vset(1.0), vfma(vmul(r, r), q, r));
+
+        // 2^n собирается прямо в поле порядка
+        I e = isll(iadd64(nBits, iset64(1023 - 0x4338000000000000LL)), 52);
+        y = vmul(p, asDouble(e));
+
+        return vmovemask(vcmple(vabs(x), vset(708.0)));
+    }
+
+    static inline double scalar(double x) { return std::exp(x); }
+};
+
+struct LogKernel {
+    static inline int block(V x, V& y)
+    {
+        const V ln2Hi = vset(6.93147180369123816490e-01);
+        const V ln2Lo = vset(1.90821492927058770002e-10);
+        const V one = vset(1.0);
+
+        // x = m * 2^k, m в [1, 2)
+        I bits = asInt(x);
+        V m = asDouble(ior(iand(bits, iset64(0x000FFFFFFFFFFFFFLL)), asInt(one)));
+        V k = vsub(asDouble(ior(isrl(bits, 52), iset64(0x4330000000000000LL))),
+                   vset(4503599627370496.0 + 1023.0));
+
+        // Приводим m к [sqrt(2)/2, sqrt(2))
+        V big = vcmpgt(m, vset(1.41421356237309504880));
+        m = vselect(big, vmul(m, vset(0.5)), m);
+        k = vadd(k, vand(big, one));
+
+        // Алгоритм fdlibm: log(1+f) = f - hfsq + s*(hfsq+R), s = f/(2+f)
+        V f = vsub(m, one);
+        V s = vdiv(f, vadd(f, vset(2.0)));
+        V z = vmul(s, s);
+        V w = vmul(z, z);
+        V t1 = vfma(w, vset(1.531383769920937332e-01), vset(2.222219843214978396e-01));
+        t1 = vfma(w, t1, vset(3.999999999940941908e-01));
+        t1 = vmul(w, t1);
+        V t2 = vfma(w, vset(1.479819860511658591e-01), vset(1.818357216161805012e-01));
+        t2 = vfma(w, t2, vset(2.857142874366239149e-01));
+        t2 = vfma(w, t2, vset(6.666666666666735130e-01));
+        t2 = vmul(z, t2);
+        V R = vadd(t2, t1);
+        V hfsq = vmul(vmul(vset(0.5), f), f);
+
+        V inner = vadd(vmul(s, vadd(hfsq, R)), vmul(k, ln2Lo));
+        y = vsub(vmul(k, ln2Hi), vsub(vsub(hfsq, inner), f));
+
+        V normal = vand(vcmpge(x, vset(2.2250738585072014e-308)),
+                        vcmple(x, vset(1.7976931348623157e+308)));
+        return vmovemask(normal);
+    }
+
+    static inline double scalar(double x) { return std::log(x); }
+};
+
+// Общая часть sin/cos/tan: редукция x = j*pi/2 + (y0 + y1), |y0| <= pi/4.
+// pi/2 представлено тремя частями по 33 бита (как в fdlibm), поэтому
+// произведения j*P1 и j*P2 точны при |j| < 2^20, а остаток хранится
+// в виде суммы двух double. Далее многочлены fdlibm __kernel_sin/__kernel_cos
+// с поправкой на младшую часть остатка.
+static inline int sinCosReduce(V x, V& sinR, V& cosR, I& quadrant)
+{
+    V j = roundToInt(vmul(x, vset(6.36619772367581382433e-01)), quadrant);
+    V r = vsub(x, vmul(j, vset(1.57079632673412561417e+00)));
+    V w = vmul(j, vset(6.07710050630396597660e-11));
+    V t = r;
+    r = vsub(t, w);
+    w = vsub(vmul(j, vset(2.02226624879595063154e-21)), vsub(vsub(t, r), w));
+    V y0 = vsub(r, w);
+    V y1 = vsub(vsub(r, y0), w);
+
+    V z = vmul(y0, y0);
+    V half = vset(0.5);
+
+    V ps = vfma(z, vset(1.58969099521155010221e-10), vset(-2.50507602534068634195e-08));
+    ps = vfma(z, ps, vset(2.75573137070700676789e-06));
+    ps = vfma(z, ps, vset(-1.98412698298579493134e-04));
+    ps = vfma(z, ps, vset(8.33333333332248946124e-03));
+    V v = vmul(z, y0);
+    V corr = vsub(vmul(z, vsub(vmul(half, y1), vmul(v, ps))), y1);
+    sinR = vsub(y0, vsub(corr, vmul(v, vset(-1.66666666666666324348e-01))));
+
+    V pc = vfma(z, vset(-1.13596475577881948265e-11), vset(2.08757232129817482790e-09));
+    pc = vfma(z, pc, vset(-2.75573143513906633035e-07));
+    pc = vfma(z, pc, vset(2.48015872894767294178e-05));
+    pc = vfma(z, pc, vset(-1.38888888888741095749e-03));
+    pc = vfma(z, pc, vset(4.16666666666666019037e-02));
+    V hz = vmul(half, z);
+    V one = vset(1.0);
+    V cw = vsub(one, hz);
+    V tail = vsub(vmul(vmul(z, z), pc), vmul(y0, y1));
+    cosR = vadd(cw, vadd(vsub(vsub(one, cw), hz), tail));
+
+    return vmovemask(vcmple(vabs(x), vset(1.0e5)));
+}
+
+// Знак результата по второму биту номера четверти
+static inline V quadrantSign(I quadrant)
+{
+    return asDouble(isll(iand(quadrant, iset64(2)), 62));
+}
+
+struct SinKernel {
+    static inline int block(V x, V& y)
+    {
+        V s, c;
+        I q;
+        int ok = sinCosReduce(x, s, c, q);
+        y = vxor(vselect(maskBit0(q), c, s), quadrantSign(q));
+        return ok;
+    }
+
+    static inline double scalar(double x) { return std::sin(x); }
+};
+
+struct CosKernel {
+    static inline int block(V x, V& y)
+    {
+        V s, c;
+        I q;
+        int ok = sinCosReduce(x, s, c, q);
+        q = iadd64(q, iset64(1)); // cos(x) = sin(x + pi/2)
+        y = vxor(vselect(maskBit0(q), c, s), quadrantSign(q));
+        return ok;
+    }
+
+    static inline double scalar(double x) { return std::cos(x); }
+};
+
+struct TanKernel {
+    static inline int block(V x, V& y)
+    {
+        V s, c;
+        I q;
+        int ok = sinCosReduce(x, s, c, q);
+        // Чётная четверть: sin/cos, нечётная: -cos/sin
+        V odd = maskBit0(q);
+        V t = vdiv(vselect(odd, c, s), vselect(odd, s, c));
+        y = vxor(t, vand(odd, vset(-0.0)));
+        return ok;
+    }
+
+    static inline double scalar(double x) { return std::tan(x); }
+};
+
+// Пересчёт скалярной функцией тех элементов блока, для которых ядро
+// не даёт гарантий точности (маска ok)
+template <class Kernel>
+static inline void fixup(V x, double* y, int ok, int count)
+{
+    double in[W];
+    vstore(in, x);
+    for (int j = 0; j < count; ++j) {
+        if (!((ok >> j) & 1)) {
+            y[j] = Kernel::scalar(in[j]);
+        }
+    }
+}
+
+// Проход по массиву блоками по W элементов. Хвост дополняется до полного
+// блока, чтобы все элементы считались одним и тем же ядром.
+template <class Kernel>
+static void apply(const double* x, double* y, int n)
+{
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        V xv = vload(x + i);
+        V yv;
+        int ok = Kernel::block(xv, yv);
+        vstore(y + i, yv);
+        if (ok != FullMask) {
+            fixup<Kernel>(xv, y + i, ok, W);
+        }
+    }
+
+    if (i < n) {
+        const int count = n - i;
+        double in[W];
+        double out[W];
+        for (int j = 0; j < W; ++j) {
+            in[j] = j < count ? x[i + j] : 0.0;
+        }
+        V xv = vload(in);
+        V yv;
+        int ok = Kernel::block(xv, yv);
+        vstore(out, yv);
+        if ((ok & ((1 << count) - 1)) != (1 << count) - 1) {
+            fixup<Kernel>(xv, out, ok, count);
+        }
+        for (int j = 0; j < count; ++j) {
+            y[i + j] = out[j];
+        }
+    }
+}
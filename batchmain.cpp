@@ -0,0 +1,75 @@
+#include "BatchRenderer.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    // Окно не нужно: если платформа не задана явно, рисуем в памяти
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Пакетная отрисовка графиков в PNG/PDF");
+    parser.addHelpOption();
+    parser.addPositionalArgument("jobs", "Файл заданий: файл; xmin; xmax; ymin; ymax; выражение[; выражение ...]");
+    QCommandLineOption sizeOption("size", "Размер изображения в пикселях (800x600).", "WxH", "800x600");
+    QCommandLineOption processesOption("processes", "Число процессов (по умолчанию — по числу ядер).", "N");
+    QCommandLineOption workerOption(BatchRenderer::WorkerOption, "Номер исполнителя.", "k/n");
+    workerOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOption(sizeOption);
+    parser.addOption(processesOption);
+    parser.addOption(workerOption);
+    parser.process(a);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1)
+        parser.showHelp(1);
+
+    const QStringList size = parser.value(sizeOption).split('x');
+    bool okWidth = false, okHeight = false;
+    const int width = size.value(0).toInt(&okWidth);
+    const int height = size.value(1).toInt(&okHeight);
+    if (size.size() != 2 || !okWidth || !okHeight || width <= 0 || height <= 0)
+    {
+        qCritical().noquote() << "Некорректный размер:" << parser.value(sizeOption);
+        return 1;
+    }
+
+    QVector<BatchRenderer::Job> jobs;
+    QStringList errors;
+    if (!BatchRenderer::readJobs(positional.first(), jobs, errors))
+    {
+        qCritical().noquote() << "Не удалось открыть" << positional.first();
+        return 1;
+    }
+
+    // Исполнитель рисует свою долю; ошибки разбора файла сообщает запустивший его процесс
+    if (parser.isSet(workerOption))
+    {
+        const QStringList worker = parser.value(workerOption).split('/');
+        const int k = worker.value(0).toInt();
+        const int n = worker.value(1).toInt();
+        if (worker.size() != 2 || n <= 0 || k < 0 || k >= n)
+            return 1;
+        return BatchRenderer::render(jobs, QSize(width, height), k, n) == 0 ? 0 : 1;
+    }
+
+    for (const QString& error : errors)
+        qWarning().noquote() << error;
+
+    int processes = parser.isSet(processesOption) ? parser.value(processesOption).toInt()
+                                                  : QThread::idealThreadCount();
+    processes = std::min(processes, static_cast<int>(jobs.size()));
+
+    int failed = 0;
+    if (processes <= 1)
+        failed = BatchRenderer::render(jobs, QSize(width, height));
+    else
+        failed = BatchRenderer::runWorkers(QCoreApplication::arguments().mid(1), processes);
+
+    return errors.isEmpty() && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+#include "Parser.h"
+#include "graphicwidget.h"
+#include <QApplication>
+#include <QtTest>
+#include <atomic>
+#include <memory>
+#include <random>
+
+namespace {
+
+// Функция-обёртка: считает вычисленные точки, остальное передаёт дальше
+class CountingFunction : public Function
+{
+public:
+    explicit CountingFunction(Function* func) : m_func(func) {}
+
+    double evaluate(double x) const override
+    {
+        ++m_points;
+        return m_func->evaluate(x);
+    }
+    void evaluate(const double* xs, double* ys, int n) const override
+    {
+        m_points += n;
+        m_func->evaluate(xs, ys, n);
+    }
+    void setCoefficients(const QVector<double>& coeffs) override { m_func->setCoefficients(coeffs); }
+    QVector<double> getCoefficients() const override { return m_func->getCoefficients(); }
+    QString getName() const override { return m_func->getName(); }
+    Kind kind() const override { return m_func->kind(); }
+    int capabilities() const override { return m_func->capabilities(); }
+    void domain(double& lower, double& upper) const override { m_func->domain(lower, upper); }
+    double period() const override { return m_func->period(); }
+    bool singularities(double lower, double upper, int maxCount, QVector<double>& breaks) const override
+    {
+        return m_func->singularities(lower, upper, maxCount, breaks);
+    }
+    void breakpoints(double lower, double upper, QVector<double>& points) const override
+    {
+        m_func->breakpoints(lower, upper, points);
+    }
+    Interval bounds(double lower, double upper) const override { return m_func->bounds(lower, upper); }
+
+    qint64 points() const { return m_points; }
+    void reset() { m_points = 0; }
+
+private:
+    std::unique_ptr<Function> m_func;
+    // Задания вычисляют функцию из нескольких потоков
+    mutable std::atomic<qint64> m_points{0};
+};
+
+// Функция на графике, подсчёт вычислений которой начинается с нуля
+CountingFunction* addCounted(GraphicWidget& widget)
+{
+    ExpressionParser parser;
+    CountingFunction* func = new CountingFunction(parser.parse("x*sin(x) + cos(3*x)"));
+    widget.addFunction(func);
+    return func;
+}
+
+// Довести отсчёты до текущего диапазона: отложенные пересчёт и перерисовка
+// выполняются, задания дожидаются
+void settle(GraphicWidget& widget)
+{
+    QCoreApplication::processEvents();
+    widget.finishSampling();
+    QCoreApplication::processEvents();
+}
+
+} // namespace
+
+class BenchGraphicEditor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseCorpus();
+    void parseCached();
+    void rangeUpdate();
+    void yPan();
+    void yZoom();
+
+private:
+    // Выражений в корпусе для замера разбора
+    static const int CorpusSize = 100000;
+    // Различных выражений при замере кэша: все помещаются в него
+    static const int CachedExpressions = 200;
+
+    QStringList m_corpus;
+};
+
+void BenchGraphicEditor::initTestCase()
+{
+    // Шаблонные функции и выражения, уходящие в байт-код, со случайными
+    // коэффициентами: строки почти не повторяются
+    const char* templates[] = {
+        "%1*x^3 - %2*x + %3",
+        "%1*sin(%2*x + %3) + %4",
+        "%1*exp(%2*x) - %3",
+        "%1*log_2(%2*x + %3)",
+        "|%1*x - %2| + %3",
+        "x*sin(%1*x) + %2/x",
+        "(x + %1)^2 / (x - %2)",
+        "sqrt(|%1*x|) + cos(x)^2",
+        "%1^x - tan(x/%2)",
+        "ln(x^2 + %1) * %2"
+    };
+    const int templateCount = int(sizeof(templates) / sizeof(templates[0]));
+
+    std::mt19937 random(6);
+    std::uniform_real_distribution<double> coefficient(0.1, 10.0);
+    m_corpus.reserve(CorpusSize);
+    for (int i = 0; i < CorpusSize; ++i)
+    {
+        QString expression = QString::fromLatin1(templates[i % templateCount]);
+        for (int k = 1; k <= 4; ++k)
+            expression.replace(QLatin1Char('%') + QString::number(k), QString::number(coefficient(random), 'g', 4));
+        m_corpus.append(expression);
+    }
+
+    // Замер имеет смысл, только если весь корпус разбирается
+    ExpressionParser parser;
+    for (const QString& expression : m_corpus)
+    {
+        std::unique_ptr<Function> func(parser.parse(expression));
+        QVERIFY2(func, qPrintable(expression));
+    }
+}
+
+void BenchGraphicEditor::parseCorpus()
+{
+    ExpressionParser parser;
+    QBENCHMARK {
+        for (const QString& expression : m_corpus)
+            std::unique_ptr<Function> func(parser.parse(expression));
+    }
+}
+
+void BenchGraphicEditor::parseCached()
+{
+    // Повторный ввод: нормализация и поиск в кэше вместо разбора
+    ParserCache cache;
+    for (int i = 0; i < CachedExpressions; ++i)
+        QVERIFY(cache.parse(m_corpus.at(i)));
+    QBENCHMARK {
+        for (int i = 0; i < CorpusSize; ++i)
+            cache.parse(m_corpus.at(i % CachedExpressions));
+    }
+    QCOMPARE(cache.misses(), int(CachedExpressions));
+}
+
+void BenchGraphicEditor::rangeUpdate()
+{
+    // Стоимость одного пересчёта: график сразу строится на нужном диапазоне
+    qint64 oneResample = 0;
+    {
+        GraphicWidget widget;
+        widget.resize(800, 600);
+        widget.show();
+        widget.setRange(-20.0, 20.0, -8.0, 8.0);
+        // Раскладка до добавления: первая выборка уже по размеру области графика
+        settle(widget);
+        CountingFunction* func = addCounted(widget);
+        settle(widget);
+        oneResample = func->points();
+    }
+    QVERIFY(oneResample > 0);
+
+    // setRange меняет обе оси, но изменения сводятся в один пересчёт
+    GraphicWidget widget;
+    widget.resize(800, 600);
+    widget.show();
+    widget.setRange(-10.0, 10.0, -5.0, 5.0);
+    settle(widget);
+    CountingFunction* func = addCounted(widget);
+    settle(widget);
+    func->reset();
+    widget.setRange(-20.0, 20.0, -8.0, 8.0);
+    settle(widget);
+
+    QVERIFY2(func->points() <= oneResample + oneResample / 4,
+             qPrintable(QString("%1 вычислений, один пересчёт — %2").arg(func->points()).arg(oneResample)));
+    QTest::setBenchmarkResult(func->points(), QTest::Events);
+}
+
+void BenchGraphicEditor::yPan()
+{
+    // Сдвиг по y в пределах yCull: значения функции не вычисляются
+    GraphicWidget widget;
+    widget.resize(800, 600);
+    widget.show();
+    widget.setRange(-10.0, 10.0, -5.0, 5.0);
+    settle(widget);
+    CountingFunction* func = addCounted(widget);
+    settle(widget);
+    func->reset();
+    for (int i = 1; i <= 10; ++i)
+    {
+        widget.setYRange(-5.0 + 0.5 * i, 5.0 + 0.5 * i);
+        settle(widget);
+    }
+
+    QCOMPARE(func->points(), qint64(0));
+    QTest::setBenchmarkResult(func->points(), QTest::Events);
+}
+
+void BenchGraphicEditor::yZoom()
+{
+    // Масштабирование по y меняет yScale: уточнение считается заново
+    GraphicWidget widget;
+    widget.resize(800, 600);
+    widget.show();
+    widget.setRange(-10.0, 10.0, -5.0, 5.0);
+    settle(widget);
+    CountingFunction* func = addCounted(widget);
+    settle(widget);
+    func->reset();
+    widget.setYRange(-2.5, 2.5);
+    settle(widget);
+
+    QVERIFY(func->points() > 0);
+    QTest::setBenchmarkResult(func->points(), QTest::Events);
+}
+
+int main(int argc, char *argv[])
+{
+    // Окно не нужно: если платформа не задана явно, рисуем в памяти
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication a(argc, argv);
+
+    BenchGraphicEditor bench;
+    return QTest::qExec(&bench, argc, argv);
+}
+
+#include "bench_graphiceditor.moc"
@@ -1,4 +1,64 @@
 #include "graphicwidget.h"
+#include "FunctionSampler.h"
+#include "ColumnGraph.h"
+#include "MappedGraph.h"
+#include "StreamGraph.h"
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+
+// Задание пула: кусок сетки first..last одной функции. Результат
+// возвращается в поток GUI очередью событий
+class GraphicWidget::SampleTask : public QRunnable
+{
+public:
+    SampleTask(GraphicWidget* widget, const FunctionInfo& info, int index, int chunk,
+               qint64 first, qint64 last, bool dropFirst, bool dropLast)
+        : m_widget(widget), m_function(info.function), m_cancelled(info.cancelled),
+          m_index(index), m_generation(info.generation), m_chunk(chunk),
+          m_step(info.gridStep), m_yScale(info.yScale), m_yCull(info.yCull),
+          m_first(first), m_last(last), m_dropFirst(dropFirst), m_dropLast(dropLast)
+    {
+    }
+
+    void run() override
+    {
+        if (m_cancelled->load())
+            return;
+
+        // Крайние узлы куска, которые уже есть в данных или в соседнем куске,
+        // участвуют только в уточнении
+        QVector<QCPGraphData> samples;
+        FunctionSampler::sample(*m_function, m_step, m_yScale, m_yCull, m_first, m_last, samples);
+        if (m_dropLast)
+            samples.removeLast();
+        if (m_dropFirst)
+            samples.removeFirst();
+
+        GraphicWidget* widget = m_widget;
+        const int index = m_index;
+        const quint64 generation = m_generation;
+        const int chunk = m_chunk;
+        QMetaObject::invokeMethod(widget, [widget, index, generation, chunk, samples]() {
+            widget->onChunkReady(index, generation, chunk, samples);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    GraphicWidget* m_widget;
+    std::shared_ptr<const Function> m_function;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    int m_index;
+    quint64 m_generation;
+    int m_chunk;
+    double m_step;
+    double m_yScale;
+    QCPRange m_yCull;
+    qint64 m_first;
+    qint64 m_last;
+    bool m_dropFirst;
+    bool m_dropLast;
+};
 
 GraphicWidget::GraphicWidget(QWidget *parent)
     : QWidget(parent)
@@ -20,14 +80,28 @@ GraphicWidget::GraphicWidget(QWidget *parent)
     m_plot->xAxis->grid()->setVisible(true);
     m_plot->yAxis->grid()->setVisible(true);
 
+    // Значения функций зависят только от оси x, поэтому rangeChanged оси y
+    // не подключён. Ось y влияет на уточнение и отсечение невидимых участков,
+    // это проверяется после раскладки (onLayoutChanged): масштабирование
+    // по y меняет yScale и пересчитывает сетку заново, сдвиг по y — только
+    // если видимый диапазон вышел за yCull. Сдвиг внутри yCull лишь перерисовывает
     connect(m_plot->xAxis, static_cast<void (QCPAxis::*)(const QCPRange &)>(&QCPAxis::rangeChanged),
             this, &GraphicWidget::onRangeChanged);
-    connect(m_plot->yAxis, static_cast<void (QCPAxis::*)(const QCPRange &)>(&QCPAxis::rangeChanged),
-            this, &GraphicWidget::onRangeChanged);
+    // Плотность отсчётов зависит от размеров области графика в пикселях:
+    // после раскладки проверяем, не изменились ли они (и масштаб по y)
+    connect(m_plot, &QCustomPlot::afterLayout, this, &GraphicWidget::onLayoutChanged);
+    // Двойной щелчок по графику подгоняет ось y под функции
+    connect(m_plot, &QCustomPlot::mouseDoubleClick, this, [this]() { fitYRange(); });
+
+    m_streamTimer.setInterval(StreamInterval);
+    connect(&m_streamTimer, &QTimer::timeout, this, &GraphicWidget::drainStreams);
 }
 
 GraphicWidget::~GraphicWidget()
 {
+    // Задания обращаются к виджету: дожидаемся их до разрушения
+    m_pool.clear();
+    m_pool.waitForDone();
     clearFunctions();
 }
 
@@ -37,71 +111,30 @@ int GraphicWidget::functionsCount() const
 }
 
 void GraphicWidget::addFunction(Function* func, const QColor& color)
+{
+    addFunction(std::shared_ptr<const Function>(func), color);
+}
+
+void GraphicWidget::addFunction(std::shared_ptr<const Function> func, const QColor& color)
 {
     QCPGraph* graph = m_plot->addGraph();
     graph->setPen(QPen(color));
 
-    QVector<double> xData, yData;
-    const int pointsCount = 1000;
-    double xMin = m_plot->xAxis->range().lower;
-    double xMax = m_plot->xAxis->range().upper;
-
-    // Для логарифмических функций корректируем диапазон
-    if (func->getName() == "Logarithmic") {
-        xMin = std::max(xMin, -10.0); // Минимальное значение для поиска асимптоты
-    }
-
-    double step = (xMax - xMin) / pointsCount;
-
-    // Находим точку, где аргумент логарифма равен 0 (асимптота)
-    double asymptoteX = std::numeric_limits<double>::max();
-    if (func->getName() == "Logarithmic") {
-        QVector<double> coeffs = func->getCoefficients();
-        double c = coeffs[2];
-        double d = coeffs[3];
-        if (c != 0) {
-            asymptoteX = -d/c;
-        }
-    }
-
-    // Строим график
-    for (int i = 0; i <= pointsCount; ++i) {
-        double x = xMin + i * step;
-
-        // Добавляем точки вблизи асимптоты для лучшего отображения
-        if (func->getName() == "Logarithmic" &&
-            std::abs(x - asymptoteX) < step*2) {
-            // Точки слева от асимптоты
-            double x_left = asymptoteX - step*10;
-            double y_left = func->evaluate(x_left);
-            xData.append(x_left);
-            yData.append(y_left);
-
-            // Точки справа от асимптоты
-            double x_right = asymptoteX + step*10;
-            double y_right = func->evaluate(x_right);
-            xData.append(x_right);
-            yData.append(y_right);
-        }
-
-        double y = func->evaluate(x);
-        xData.append(x);
-        yData.append(y);
-    }
-
-    // Настройки для отображения асимптоты
+    // Асимптоты и границы области определения расставляет FunctionSampler:
+    // NaN в точке разрыва рвёт линию, около разрыва точки сгущаются
     graph->setLineStyle(QCPGraph::lsLine);
     graph->setScatterStyle(QCPScatterStyle::ssNone);
-    graph->setData(xData, yData);
 
-    m_functions.append({func, graph});
-    m_plot->replot();
+    m_functions.append({std::move(func), graph});
+    resampleFunction(m_functions.size() - 1, false);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void GraphicWidget::clearFunctions()
 {
     for (auto& funcInfo : m_functions) {
-        delete funcInfo.function;
+        if (funcInfo.cancelled)
+            funcInfo.cancelled->store(true);
         m_plot->removeGraph(funcInfo.graph);
     }
     m_functions.clear();
@@ -109,64 +142,44 @@ void GraphicWidget::clearFunctions()
 }
 
 void GraphicWidget::setMainFunction(Function* func, const QColor& color)
+{
+    setMainFunction(std::shared_ptr<const Function>(func), color);
+}
+
+void GraphicWidget::setMainFunction(std::shared_ptr<const Function> func, const QColor& color)
 {
     if (!m_functions.isEmpty())
     {
         // Заменяем данные первого графика
         FunctionInfo& mainInfo = m_functions[0];
 
-        delete mainInfo.function;
-        mainInfo.function = func;
-
-        QVector<double> xData, yData;
-
-        const int pointsCount = 1000;
-        double xMin = m_plot->xAxis->range().lower;
-        double xMax = m_plot->xAxis->range().upper;
-        double step = (xMax - xMin) / pointsCount;
-
-        for (int i = 0; i <= pointsCount; ++i)
-        {
-            double x = xMin + i * step;
-            xData.append(x);
-            yData.append(func->evaluate(x));
-        }
+        mainInfo.function = std::move(func);
 
         mainInfo.graph->setPen(QPen(color));
-        mainInfo.graph->setData(xData, yData);
+        resampleFunction(0, false);
     }
     else
     {
         addFunction(func, color);
     }
-    m_plot->replot();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void GraphicWidget::setSecondaryFunction(Function* func, const QColor& color)
+{
+    setSecondaryFunction(std::shared_ptr<const Function>(func), color);
+}
+
+void GraphicWidget::setSecondaryFunction(std::shared_ptr<const Function> func, const QColor& color)
 {
     if (m_functions.size() > 1)
     {
         FunctionInfo& secondInfo = m_functions[1];
 
-        delete secondInfo.function;
-        secondInfo.function = func;
-
-        QVector<double> xData, yData;
-
-        const int pointsCount = 1000;
-        double xMin = m_plot->xAxis->range().lower;
-        double xMax = m_plot->xAxis->range().upper;
-        double step = (xMax - xMin) / pointsCount;
-
-        for (int i = 0; i <= pointsCount; ++i)
-        {
-            double x = xMin + i * step;
-            xData.append(x);
-            yData.append(func->evaluate(x));
-        }
+        secondInfo.function = std::move(func);
 
         secondInfo.graph->setPen(QPen(color));
-        secondInfo.graph->setData(xData, yData);
+        resampleFunction(1, false);
     }
     else if (m_functions.size() == 1)
     {
@@ -176,19 +189,21 @@ void GraphicWidget::setSecondaryFunction(Function* func, const QColor& color)
     {
         addFunction(func, color);
     }
-    m_plot->replot();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void GraphicWidget::setXRange(double xmin, double xmax)
 {
+    // Пересчёт запланирует onRangeChanged
     m_plot->xAxis->setRange(xmin, xmax);
-    updateAllFunctions();
 }
 
 void GraphicWidget::setYRange(double ymin, double ymax)
 {
+    // Пересчёт, если нужен (другой масштаб или выход за yCull), запустит
+    // раскладка при перерисовке
     m_plot->yAxis->setRange(ymin, ymax);
-    updateAllFunctions();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void GraphicWidget::setRange(double xmin, double xmax, double ymin, double ymax)
@@ -197,51 +212,392 @@ void GraphicWidget::setRange(double xmin, double xmax, double ymin, double ymax)
     setYRange(ymin, ymax);
 }
 
-void GraphicWidget::onRangeChanged(const QCPRange &newRange)
+void GraphicWidget::addStream(std::shared_ptr<DataStream> stream, const QColor& color, double window)
 {
-    Q_UNUSED(newRange);
+    // Записи телеметрии бывают очень длинными: график хранит их кусками
+    // и прореживает по пирамиде min/max
+    StreamGraph* graph = new StreamGraph(m_plot->xAxis, m_plot->yAxis);
+    graph->setPen(QPen(color));
+    graph->setLineStyle(QCPGraph::lsLine);
+    graph->setScatterStyle(QCPScatterStyle::ssNone);
+
+    m_streams.append({std::move(stream), graph, window});
+    m_streamTimer.start();
+}
+
+void GraphicWidget::clearStreams()
+{
+    m_streamTimer.stop();
+    for (auto& streamInfo : m_streams)
+        m_plot->removeGraph(streamInfo.graph);
+    m_streams.clear();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GraphicWidget::addSeries(std::shared_ptr<const MappedSeries> series, const QColor& color)
+{
+    QCPGraph* graph = new MappedGraph(m_plot->xAxis, m_plot->yAxis, std::move(series));
+    graph->setPen(QPen(color));
+    graph->setLineStyle(QCPGraph::lsLine);
+    graph->setScatterStyle(QCPScatterStyle::ssNone);
+
+    m_series.append(graph);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GraphicWidget::addSeries(std::shared_ptr<const ColumnSeries> series, const QColor& color)
+{
+    QCPGraph* graph = new ColumnGraph(m_plot->xAxis, m_plot->yAxis, std::move(series));
+    graph->setPen(QPen(color));
+    graph->setLineStyle(QCPGraph::lsLine);
+    graph->setScatterStyle(QCPScatterStyle::ssNone);
+
+    m_series.append(graph);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
 
-    // Для каждого графика пересчитать данные по новому диапазону оси x
-    const int pointsCount = 1000;
-    double xMin = m_plot->xAxis->range().lower;
-    double xMax = m_plot->xAxis->range().upper;
-    double step = (xMax - xMin) / pointsCount;
+void GraphicWidget::clearSeries()
+{
+    for (QCPGraph* graph : m_series)
+        m_plot->removeGraph(graph);
+    m_series.clear();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
 
-    for (auto& funcInfo : m_functions)
+void GraphicWidget::drainStreams()
+{
+    bool changed = false;
+    for (auto& streamInfo : m_streams)
     {
-        QVector<double> xData, yData;
-        for (int i = 0; i <= pointsCount; ++i)
+        if (streamInfo.stream->drain(m_streamBuffer) == 0)
+            continue;
+
+        // Ключи неубывающие: кадр дописывается в конец без сортировки.
+        // Порядок всё же проверяем, чтобы не испортить данные
+        auto keyLess = [](const QCPGraphData& a, const QCPGraphData& b) { return a.key < b.key; };
+        if (!std::is_sorted(m_streamBuffer.constBegin(), m_streamBuffer.constEnd(), keyLess))
+            std::stable_sort(m_streamBuffer.begin(), m_streamBuffer.end(), keyLess);
+        streamInfo.graph->append(m_streamBuffer);
+        if (streamInfo.window > 0)
+            streamInfo.graph->removeBefore(streamInfo.graph->lastKey() - streamInfo.window);
+        changed = true;
+    }
+    if (changed)
+        m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GraphicWidget::setSamplingThreads(int count)
+{
+    m_pool.setMaxThreadCount(count);
+}
+
+void GraphicWidget::finishSampling()
+{
+    // Раскладка по текущему размеру может сменить сетку и запустить новые
+    // задания: повторяем, пока после перерисовки не останется работы
+    forever
+    {
+        m_plot->replot();
+        if (!isSampling())
+            break;
+        while (isSampling())
         {
-            double x = xMin + i * step;
-            xData.append(x);
-            yData.append(funcInfo.function->evaluate(x));
+            // Результаты заданий приходят очередью событий
+            m_pool.waitForDone();
+            QCoreApplication::processEvents();
         }
-        funcInfo.graph->setData(xData, yData);
     }
+}
 
-    m_plot->replot();
+void GraphicWidget::fitYRange()
+{
+    QCPRange range;
+    bool found = false;
+    const QCPRange xRange = m_plot->xAxis->range();
+    for (const auto& info : m_functions)
+    {
+        bool foundFunction = false;
+        const QCPRange functionRange = FunctionSampler::valueRange(*info.function, xRange.lower, xRange.upper,
+                                                                   foundFunction);
+        if (!foundFunction)
+            continue;
+        if (found)
+            range.expand(functionRange);
+        else
+            range = functionRange;
+        found = true;
+    }
+    if (!found)
+        return;
+    // Постоянной функции нужен ненулевой диапазон
+    if (range.size() == 0)
+        range = QCPRange(range.lower - 1, range.upper + 1);
+    m_plot->yAxis->setRange(range);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+bool GraphicWidget::save(const QString& fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "pdf")
+        return m_plot->savePdf(fileName);
+    if (suffix == "jpg" || suffix == "jpeg")
+        return m_plot->saveJpg(fileName);
+    if (suffix == "bmp")
+        return m_plot->saveBmp(fileName);
+    return m_plot->savePng(fileName);
+}
+
+bool GraphicWidget::isSampling() const
+{
+    if (m_updatePending)
+        return true;
+    for (const auto& info : m_functions)
+    {
+        if (info.busy)
+            return true;
+    }
+    return false;
+}
+
+void GraphicWidget::onRangeChanged(const QCPRange &newRange)
+{
+    Q_UNUSED(newRange);
+    scheduleUpdate();
+}
+
+void GraphicWidget::onLayoutChanged()
+{
+    // Вызывается внутри replot до отрисовки: если пиксельная сетка
+    // не изменилась, новых заданий не будет
+    for (int i = 0; i < m_functions.size(); ++i)
+    {
+        resampleFunction(i, true);
+    }
+}
+
+void GraphicWidget::scheduleUpdate()
+{
+    // Несколько изменений диапазона за один проход цикла событий
+    // (перетаскивание, setRange) дают один пересчёт
+    if (m_updatePending)
+        return;
+    m_updatePending = true;
+    QTimer::singleShot(0, this, &GraphicWidget::updateAllFunctions);
 }
 
 void GraphicWidget::updateAllFunctions()
 {
-    // При изменении диапазона обновляем все графики
-    for (auto& funcInfo : m_functions)
+    m_updatePending = false;
+
+    // Для каждого графика досчитать данные по новому диапазону оси x;
+    // перерисовка — по готовности заданий
+    for (int i = 0; i < m_functions.size(); ++i)
+    {
+        resampleFunction(i, true);
+    }
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GraphicWidget::resampleFunction(int index, bool incremental)
+{
+    FunctionInfo& info = m_functions[index];
+    const QCPRange xRange = m_plot->xAxis->range();
+    const QCPRange yRange = m_plot->yAxis->range();
+
+    // Кусочно-линейная функция точно задаётся концами диапазона и точками
+    // излома между ними: сетка, уточнение и задания не нужны
+    QVector<QCPGraphData> samples;
+    if (FunctionSampler::samplePiecewiseLinear(*info.function, xRange.lower, xRange.upper, samples))
+    {
+        // Задания прежней функции отменяются, их результаты не пройдут
+        // проверку поколения; сетки у ломаной нет
+        if (info.cancelled)
+            info.cancelled->store(true);
+        info.cancelled = std::make_shared<std::atomic<bool>>(false);
+        info.generation = ++m_generation;
+        info.gridStep = 0.0;
+        info.firstIndex = 0;
+        info.lastIndex = -1;
+        info.busy = false;
+        info.dirty = false;
+        info.chunks.clear();
+        info.graph->data()->set(samples, true);
+        return;
+    }
+
+    // Размеры области графика в пикселях устройства; до первой раскладки
+    // они ещё не известны
+    const double ratio = m_plot->bufferDevicePixelRatio();
+    double width = m_plot->axisRect()->width() * ratio;
+    double height = m_plot->axisRect()->height() * ratio;
+    if (width < 1)
+        width = DefaultPixels;
+    if (height < 1)
+        height = DefaultPixels;
+
+    // Узел сетки на каждые GridPixels пикселей (для периодических функций —
+    // целое число узлов на период), yScale — пикселей на единицу y
+    const double step = FunctionSampler::alignedStep(*info.function,
+                                                     xRange.size() * FunctionSampler::GridPixels / width);
+    const double yScale = height / yRange.size();
+    if (!(step > 0) || !(yScale > 0) || !std::isfinite(yScale))
+        return;
+
+    // Пока масштаб не меняется, сетка остаётся прежней: при панорамировании
+    // по x уже посчитанные узлы переиспользуются. Всё заново считается, если:
+    //  - изменился шаг сетки (масштаб по x или ширина области графика);
+    //  - изменился yScale (масштаб по y или высота): от него зависит уточнение;
+    //  - видимый диапазон y вышел за yCull, где данные считались подробно.
+    // Сдвиг по y внутри yCull ничего не вычисляет
+    const bool sameGrid = incremental && info.gridStep > 0 &&
+                          std::abs(step - info.gridStep) <= info.gridStep * 1e-9 &&
+                          std::abs(yScale - info.yScale) <= info.yScale * 1e-9 &&
+                          yRange.lower >= info.yCull.lower && yRange.upper <= info.yCull.upper;
+    if (!sameGrid)
     {
-        QVector<double> xData, yData;
+        // Новое поколение: задания для прежней сетки больше не нужны.
+        // Старые данные остаются на экране, пока не готовы новые
+        if (info.cancelled)
+            info.cancelled->store(true);
+        info.cancelled = std::make_shared<std::atomic<bool>>(false);
+        info.generation = ++m_generation;
+        info.gridStep = step;
+        info.yScale = yScale;
+        info.yCull = FunctionSampler::cullRange(yRange);
+        info.firstIndex = 0;
+        info.lastIndex = -1;
+        info.busy = false;
+        info.dirty = false;
+    }
+    else if (info.busy)
+    {
+        // Сдвиг на той же сетке: дождёмся пакета и досчитаем от его результата
+        info.dirty = true;
+        return;
+    }
 
-        const int pointsCount = 1000;
-        double xMin = m_plot->xAxis->range().lower;
-        double xMax = m_plot->xAxis->range().upper;
-        double step = (xMax - xMin) / pointsCount;
+    const qint64 first = static_cast<qint64>(std::floor(xRange.lower / info.gridStep));
+    const qint64 last = static_cast<qint64>(std::ceil(xRange.upper / info.gridStep));
 
-        for (int i = 0; i <= pointsCount; ++i)
+    info.chunks.clear();
+    info.prependChunks = 0;
+    info.pendingChunks = 0;
+
+    if (info.firstIndex <= info.lastIndex && first <= info.lastIndex && last >= info.firstIndex)
+    {
+        // Убираем ушедшие за край узлы и считаем только открывшиеся полосы
+        QSharedPointer<QCPGraphDataContainer> data = info.graph->data();
+        if (first > info.firstIndex)
+        {
+            data->removeBefore(first * info.gridStep);
+            info.firstIndex = first;
+        }
+        if (last < info.lastIndex)
         {
-            double x = xMin + i * step;
-            xData.append(x);
-            yData.append(funcInfo.function->evaluate(x));
+            data->removeAfter(last * info.gridStep);
+            info.lastIndex = last;
         }
+        if (first >= info.firstIndex && last <= info.lastIndex)
+            return;
 
-        funcInfo.graph->setData(xData, yData);
+        info.replace = false;
+        info.pendingFirst = std::min(first, info.firstIndex);
+        info.pendingLast = std::max(last, info.lastIndex);
+
+        // Полоса включает крайний узел данных, чтобы уточнить отрезок на стыке;
+        // сам узел уже есть и отбрасывается
+        if (first < info.firstIndex)
+        {
+            dispatchSpan(index, first, info.firstIndex, false, true);
+            info.prependChunks = info.chunks.size();
+        }
+        if (last > info.lastIndex)
+            dispatchSpan(index, info.lastIndex, last, true, false);
     }
-    m_plot->replot();
+    else
+    {
+        info.replace = true;
+        info.pendingFirst = first;
+        info.pendingLast = last;
+        dispatchSpan(index, first, last, false, false);
+    }
+    info.busy = true;
+}
+
+void GraphicWidget::dispatchSpan(int index, qint64 first, qint64 last, bool dropFirst, bool dropLast)
+{
+    // Соседние куски делят общий узел: он остаётся только в правом куске
+    FunctionInfo& info = m_functions[index];
+    for (qint64 start = first; start < last; start += ChunkNodes)
+    {
+        const qint64 end = std::min(start + ChunkNodes, last);
+        const bool lastChunk = end == last;
+        const int chunk = info.chunks.size();
+        info.chunks.append(QVector<QCPGraphData>());
+        ++info.pendingChunks;
+        m_pool.start(new SampleTask(this, info, index, chunk, start, end,
+                                    start == first && dropFirst,
+                                    !lastChunk || dropLast));
+    }
+}
+
+void GraphicWidget::onChunkReady(int index, quint64 generation, int chunk, const QVector<QCPGraphData>& samples)
+{
+    // Результат для удалённой функции или прежней сетки
+    if (index >= m_functions.size())
+        return;
+    FunctionInfo& info = m_functions[index];
+    if (info.generation != generation || !info.busy)
+        return;
+
+    info.chunks[chunk] = samples;
+    if (--info.pendingChunks > 0)
+        return;
+
+    // Пакет готов: куски упорядочены по x
+    if (info.replace)
+    {
+        // Новые данные собираются в отдельном контейнере и подменяют
+        // отображаемые целиком. Единственный кусок передаётся без копирования
+        // (QVector разделяет данные), несколько — одним копированием
+        QVector<QCPGraphData> merged;
+        if (info.chunks.size() == 1)
+        {
+            merged = info.chunks.first();
+        }
+        else
+        {
+            int total = 0;
+            for (const auto& part : info.chunks)
+                total += part.size();
+            merged.reserve(total);
+            for (const auto& part : info.chunks)
+                merged += part;
+        }
+        QSharedPointer<QCPGraphDataContainer> buffer(new QCPGraphDataContainer);
+        buffer->set(merged, true);
+        info.graph->setData(buffer);
+    }
+    else
+    {
+        // Левые куски добавляем справа налево, правые — слева направо:
+        // каждый ложится в начало или в конец контейнера без сортировки
+        QSharedPointer<QCPGraphDataContainer> data = info.graph->data();
+        for (int k = info.prependChunks - 1; k >= 0; --k)
+            data->add(info.chunks[k], true);
+        for (int k = info.prependChunks; k < info.chunks.size(); ++k)
+            data->add(info.chunks[k], true);
+    }
+    info.chunks.clear();
+    info.firstIndex = info.pendingFirst;
+    info.lastIndex = info.pendingLast;
+    info.busy = false;
+
+    if (info.dirty)
+    {
+        info.dirty = false;
+        resampleFunction(index, true);
+    }
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
 }
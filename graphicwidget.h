@@ -2,8 +2,16 @@
 #define GRAPHICWIDGET_H
 
 #include <QWidget>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
 #include "qcustomplot.h"
 #include "Function.h"
+#include "DataStream.h"
+#include "MappedSeries.h"
+#include "ColumnSeries.h"
+
+class StreamGraph;
 
 class GraphicWidget : public QWidget
 {
@@ -14,24 +22,109 @@ public:
     ~GraphicWidget();
 
     int functionsCount() const;
+    // Перегрузки с Function* забирают владение функцией, с shared_ptr —
+    // разделяют её (например, с ParserCache)
     void addFunction(Function* func, const QColor& color = QColor("#1E2A78"));
+    void addFunction(std::shared_ptr<const Function> func, const QColor& color = QColor("#1E2A78"));
     void clearFunctions();
     void setMainFunction(Function* func, const QColor& color = QColor("#1E2A78"));
+    void setMainFunction(std::shared_ptr<const Function> func, const QColor& color = QColor("#1E2A78"));
     void setSecondaryFunction(Function* func, const QColor& color = QColor("#FF2E4C"));
+    void setSecondaryFunction(std::shared_ptr<const Function> func, const QColor& color = QColor("#FF2E4C"));
     void setXRange(double xmin, double xmax);
     void setYRange(double ymin, double ymax);
     void setRange(double xmin, double xmax, double ymin, double ymax);
+    // Диапазон y по функциям на текущем диапазоне x — по интервальным
+    // оценкам (Function::bounds), без вычисления на сетке. Вызывается
+    // и двойным щелчком по графику
+    void fitYRange();
+
+    // Живой ряд поверх функций: отсчёты забираются из stream с частотой
+    // кадров, отсчёты старше window от последнего ключа удаляются (0 — хранить все)
+    void addStream(std::shared_ptr<DataStream> stream, const QColor& color, double window = 0.0);
+    void clearStreams();
+    // Ряд из файла (MappedSeries): в памяти держится только видимый участок
+    void addSeries(std::shared_ptr<const MappedSeries> series, const QColor& color);
+    // Ряд в памяти (ColumnSeries); после его изменения нужна перерисовка
+    void addSeries(std::shared_ptr<const ColumnSeries> series, const QColor& color);
+    void clearSeries();
+
+    // Число потоков, вычисляющих отсчёты (по умолчанию — по числу ядер)
+    void setSamplingThreads(int count);
+    // Синхронно довести отсчёты до текущего диапазона и размера: нужно
+    // перед сохранением, когда перерисовки по готовности заданий не ждут
+    void finishSampling();
+    // Сохранить график в файл текущего размера; формат — по расширению
+    // (pdf, jpg, bmp, иначе png)
+    bool save(const QString& fileName);
 
 private:
+    class SampleTask;
+
     struct FunctionInfo {
-        Function* function;
+        // Функцией владеют и виджет, и задания, которые её ещё вычисляют
+        std::shared_ptr<const Function> function;
         QCPGraph* graph;
+        // Текущая сетка x = k * gridStep для масштаба yScale. Поколение
+        // меняется вместе с сеткой: результаты старых заданий отбрасываются,
+        // а ещё не начатые задания отменяются через cancelled
+        double gridStep = 0.0;
+        double yScale = 0.0;
+        // Диапазон y, вне которого данные посчитаны без подробностей
+        QCPRange yCull;
+        quint64 generation = 0;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        // graph->data() содержит узлы firstIndex..lastIndex текущей сетки
+        // и точки уточнения между ними (lastIndex < firstIndex — данных нет)
+        qint64 firstIndex = 0;
+        qint64 lastIndex = -1;
+        // Пакет заданий в работе: после него данные охватят pendingFirst..pendingLast.
+        // Первые prependChunks кусков ложатся левее имеющихся данных;
+        // replace — пакет заменяет данные целиком. dirty — диапазон
+        // изменился, пока пакет считался
+        bool busy = false;
+        bool dirty = false;
+        bool replace = false;
+        qint64 pendingFirst = 0;
+        qint64 pendingLast = -1;
+        int prependChunks = 0;
+        int pendingChunks = 0;
+        QVector<QVector<QCPGraphData>> chunks;
     };
+    struct StreamInfo {
+        std::shared_ptr<DataStream> stream;
+        // Один график на ряд; точки он хранит кусками
+        StreamGraph* graph;
+        double window;
+    };
+
     QVector<FunctionInfo> m_functions;
+    QVector<StreamInfo> m_streams;
+    QVector<QCPGraph*> m_series;
+    QTimer m_streamTimer;
+    // Переиспользуемый буфер для отсчётов одного кадра
+    QVector<QCPGraphData> m_streamBuffer;
     QCustomPlot* m_plot;
+    QThreadPool m_pool;
+    quint64 m_generation = 0;
+    bool m_updatePending = false;
+
+    // Число узлов сетки в одном задании
+    static const int ChunkNodes = 128;
+    // Размер области графика, пока раскладка ещё не выполнена
+    static constexpr double DefaultPixels = 1000.0;
+    // Период забора отсчётов живых рядов, мс (~60 кадров в секунду)
+    static const int StreamInterval = 16;
 
     void onRangeChanged(const QCPRange &newRange);
+    void onLayoutChanged();
+    void scheduleUpdate();
+    bool isSampling() const;
     void updateAllFunctions();
+    void resampleFunction(int index, bool incremental);
+    void dispatchSpan(int index, qint64 first, qint64 last, bool dropFirst, bool dropLast);
+    void drainStreams();
+    void onChunkReady(int index, quint64 generation, int chunk, const QVector<QCPGraphData>& samples);
 };
 
 #endif // GRAPHICWIDGET_H
@@ -36,7 +36,8 @@ void MainWindow::on_pushButton_4_clicked()
         Тригонометрическая: a*sin(b*x+c)+d<br>
         Экспоненциальная: a*exp(b*x+c)+d<br>
         Логарифмическая: a*log_b(c*x+d)+e<br>
-        Модуль: c*|a*x+b|+d
+        Модуль: c*|a*x+b|+d<br>
+        Любые комбинации: x*sin(x), (x+1)^2/x, sqrt(|x|)
         </div>
     )";
 
@@ -111,13 +112,8 @@ void MainWindow::on_pushButton_clicked()
         return;
     }
 
-    auto parser = ParserFactory::createParser(input);
-    if (!parser) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось определить тип функции");
-        return;
-    }
-
-    Function* parsedFunc = parser->parse(input);
+    // Повторный ввод того же выражения берётся из кэша без разбора
+    std::shared_ptr<const Function> parsedFunc = ParserCache::instance().parse(input);
     if (!parsedFunc) {
         QMessageBox::warning(this, "Ошибка", "Некорректный ввод функции");
         return;
@@ -168,13 +164,8 @@ void MainWindow::on_pushButton_6_clicked()
         return;
     }
 
-    auto parser = ParserFactory::createParser(input);
-    if (!parser) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось определить тип функции");
-        return;
-    }
-
-    Function* parsedFunc = parser->parse(input);
+    // Повторный ввод того же выражения берётся из кэша без разбора
+    std::shared_ptr<const Function> parsedFunc = ParserCache::instance().parse(input);
     if (!parsedFunc) {
         QMessageBox::warning(this, "Ошибка", "Некорректный ввод функции");
         return;
@@ -24,6 +24,11 @@
 ****************************************************************************/
 
 #include "qcustomplot.h"
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+#  include <QtCore/QThreadPool>
+#  include <QtCore/QSemaphore>
+#  include <functional>
+#endif
 
 
 /* including file 'src/vector2d.cpp'       */
@@ -21712,66 +21717,208 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   
   if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
     int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
     int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-    while (it != end)
+    double firstIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
+    double keyEpsilon = qAbs(firstIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(firstIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    // split large data sets into pixel-aligned chunks that are sampled in parallel:
+    const int minChunkSize = 1<<16;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int chunkCount = qMin(pool->maxThreadCount(), dataCount/minChunkSize);
+    if (chunkCount > 1)
+    {
+      getParallelAdaptiveLineData(lineData, begin, end, keyEpsilon, chunkCount);
+      return;
+    }
+#endif
+    getAdaptiveLineData(lineData, nullptr, begin, begin, end, end, keyEpsilon);
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  {
+    lineData->resize(dataCount);
+    std::copy(begin, end, lineData->begin());
+  }
+}
+
+/*! \internal
+
+  Runs the adaptive sampling algorithm of \ref getOptimizedLineData on the data between \a begin
+  and \a end, starting with a new pixel interval at \a from (which is \a begin for the whole data
+  range). The resulting points are appended to \a lineData. \a keyEpsilon is the width of one
+  pixel in key coordinates at the first interval of the whole range (it is recalculated for every
+  interval on logarithmic axes).
+
+  Sampling stops at the first interval that starts at or after \a stop, once the interval before
+  it has been appended, and the start of that interval is returned (or \a end, if no further
+  interval starts). If \a intervalStarts is non-zero, the data index (relative to \a begin) of
+  every interval start is recorded, together with the size of \a lineData at which the points of
+  that interval begin.
+
+  The output of an interval only depends on where it and the following interval start, so
+  intervals found by runs starting at different points are identical once the runs agree on an
+  interval start. \ref getParallelAdaptiveLineData uses this to stitch chunks together.
+*/
+QCPGraphDataContainer::const_iterator QCPGraph::getAdaptiveLineData(QVector<QCPGraphData> *lineData, QVector<QPair<int, int> > *intervalStarts, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &from, const QCPGraphDataContainer::const_iterator &stop, const QCPGraphDataContainer::const_iterator &end, double keyEpsilon) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPGraphDataContainer::const_iterator it = from;
+  double minValue = it->value;
+  double maxValue = it->value;
+  QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
+  int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+  int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+  double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(from->key)+reversedRound));
+  double lastIntervalEndKey = from == begin ? currentIntervalStartKey : (from-1)->key;
+  bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+  if (keyEpsilonVariable)
+    keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+  if (intervalStarts)
+    intervalStarts->append(qMakePair(int(from-begin), int(lineData->size())));
+  int intervalDataCount = 1;
+  ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
+  while (it != end)
+  {
+    if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
     {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
-      {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
-      {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
+      if (it->value < minValue)
         minValue = it->value;
+      else if (it->value > maxValue)
         maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      ++it;
+      ++intervalDataCount;
+    } else // new pixel interval started
+    {
+      if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+      {
+        if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+        if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
+      } else
+        lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+      if (it >= stop)
+        return it;
+      lastIntervalEndKey = (it-1)->key;
+      minValue = it->value;
+      maxValue = it->value;
+      currentIntervalFirstPoint = it;
+      currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
+      if (keyEpsilonVariable)
+        keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+      if (intervalStarts)
+        intervalStarts->append(qMakePair(int(it-begin), int(lineData->size())));
+      intervalDataCount = 1;
     }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+    ++it;
+  }
+  // handle last interval:
+  if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+  {
+    if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
+    lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+    lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+  } else
+    lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+  return end;
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+/*! \internal
+
+  Parallel version of the adaptive sampling in \ref getOptimizedLineData, producing exactly the
+  same \a lineData as the serial algorithm.
+
+  The data between \a begin and \a end is split into \a chunkCount chunks at pixel boundaries,
+  which are sampled by \ref getAdaptiveLineData in the global thread pool (the first chunk in the
+  calling thread). Each chunk continues past its end up to the start of the next interval. The
+  chunks are then stitched: the output of a chunk is taken from the interval where the previous
+  chunk stopped. Should a chunk not contain that interval start (its own intervals are offset from
+  the serial ones), the remaining data is sampled serially.
+*/
+void QCPGraph::getParallelAdaptiveLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, double keyEpsilon, int chunkCount) const
+{
+  class ChunkTask : public QRunnable
+  {
+  public:
+    ChunkTask(std::function<void()> work, QSemaphore *done) : mWork(work), mDone(done) { setAutoDelete(false); }
+    virtual void run() Q_DECL_OVERRIDE { mWork(); mDone->release(); }
+  private:
+    std::function<void()> mWork;
+    QSemaphore *mDone;
+  };
+  
+  QCPAxis *keyAxis = mKeyAxis.data();
+  const int dataCount = int(end-begin);
+  const int reversedFactor = keyAxis->pixelOrientation();
+  const int reversedRound = reversedFactor==-1 ? 1 : 0;
+  const bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic;
+  
+  // move chunk boundaries to the first point of the next pixel, where the serial algorithm is
+  // (almost always) starting a new interval, too:
+  QVector<QCPGraphDataContainer::const_iterator> bounds(chunkCount+1);
+  bounds[0] = begin;
+  bounds[chunkCount] = end;
+  for (int i=1; i<chunkCount; ++i)
+  {
+    QCPGraphDataContainer::const_iterator it = begin+int(qint64(dataCount)*i/chunkCount);
+    double startKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel((it-1)->key)+reversedRound));
+    double epsilon = keyEpsilonVariable ? qAbs(startKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(startKey)+1.0*reversedFactor)) : keyEpsilon;
+    it = std::lower_bound(it, end, startKey+epsilon, [](const QCPGraphData &data, double key) { return data.key < key; });
+    bounds[i] = qMax(bounds[i-1], it);
+  }
+  
+  QVector<QVector<QCPGraphData> > chunkData(chunkCount);
+  QVector<QVector<QPair<int, int> > > chunkStarts(chunkCount);
+  QVector<QCPGraphDataContainer::const_iterator> chunkResume(chunkCount, end);
+  QVector<ChunkTask*> tasks;
+  QSemaphore done;
+  for (int i=1; i<chunkCount; ++i)
+  {
+    if (bounds[i] == bounds[i+1])
+      continue;
+    std::function<void()> work = [this, i, begin, end, keyEpsilon, &bounds, &chunkData, &chunkStarts, &chunkResume]()
     {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-    } else
-      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-    
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+      chunkResume[i] = getAdaptiveLineData(&chunkData[i], &chunkStarts[i], begin, bounds.at(i), bounds.at(i+1), end, keyEpsilon);
+    };
+    tasks.append(new ChunkTask(work, &done));
+    QThreadPool::globalInstance()->start(tasks.last());
+  }
+  chunkResume[0] = getAdaptiveLineData(&chunkData[0], &chunkStarts[0], begin, begin, bounds[1], end, keyEpsilon);
+  // tasks that haven't started yet are run here, so waiting can't deadlock when called from a pool thread:
+  for (int i=0; i<tasks.size(); ++i)
   {
-    lineData->resize(dataCount);
-    std::copy(begin, end, lineData->begin());
+    if (QThreadPool::globalInstance()->tryTake(tasks.at(i)))
+      tasks.at(i)->run();
+  }
+  done.acquire(tasks.size());
+  qDeleteAll(tasks);
+  
+  // stitch chunks at the interval starts of the serial algorithm:
+  *lineData = chunkData[0];
+  QCPGraphDataContainer::const_iterator resume = chunkResume[0];
+  int chunk = 1;
+  while (resume != end)
+  {
+    while (chunk+1 < chunkCount && bounds[chunk+1] <= resume)
+      ++chunk;
+    const QVector<QPair<int, int> > &starts = chunkStarts.at(chunk);
+    QVector<QPair<int, int> >::const_iterator start = std::lower_bound(starts.constBegin(), starts.constEnd(), qMakePair(int(resume-begin), 0));
+    if (start == starts.constEnd() || start->first != int(resume-begin))
+    {
+      getAdaptiveLineData(lineData, nullptr, begin, resume, end, end, keyEpsilon);
+      break;
+    }
+    const QVector<QCPGraphData> &data = chunkData.at(chunk);
+    lineData->reserve(lineData->size()+data.size()-start->second);
+    for (int i=start->second; i<data.size(); ++i)
+      lineData->append(data.at(i));
+    resume = chunkResume.at(chunk);
+    ++chunk;
   }
 }
+#endif
 
 /*! \internal
 
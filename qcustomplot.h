@@ -2622,9 +2622,11 @@ public:
   int size() const { return mData.size()-mPreallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  bool valueRangeIndex() const { return mValueRangeIndex; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setValueRangeIndex(bool enabled);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2639,6 +2641,7 @@ public:
   void clear();
   void sort();
   void squeeze(bool preAllocation=true, bool postAllocation=true);
+  void reserve(int size);
   
   const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
   const_iterator constEnd() const { return mData.constEnd(); }
@@ -2653,17 +2656,36 @@ public:
   void limitIteratorsToDataRange(const_iterator &begin, const_iterator &end, const QCPDataRange &dataRange) const;
   
 protected:
+  // min/max of the value ranges of a block of data points, per sign domain (indexed by QCP::SignDomain):
+  struct ValueRangeNode
+  {
+    double lower[3];
+    double upper[3];
+  };
+  enum { ValueRangeBlockSize = 32 ///< number of data points summarized by one leaf of the value range index
+         ,ValueRangeMaxDirty = 8 ///< number of separate dirty regions before they are merged into one
+       };
+  
   // property members:
   bool mAutoSqueeze;
+  bool mValueRangeIndex;
   
   // non-property memebers:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  QVector<ValueRangeNode> mValueRangeTree;
+  QVector<QPair<int, int> > mValueRangeDirty;
   
   // non-virtual methods:
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void invalidateValueRange(int begin, int end);
+  void updateValueRangeIndex();
+  ValueRangeNode valueRangeOf(int begin, int end) const;
+  ValueRangeNode queryValueRange(int begin, int end) const;
+  static ValueRangeNode emptyValueRange();
+  static ValueRangeNode combineValueRange(const ValueRangeNode &a, const ValueRangeNode &b);
 };
 
 
@@ -2805,6 +2827,7 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mValueRangeIndex(false),
   mPreallocSize(0),
   mPreallocIteration(0)
 {
@@ -2829,6 +2852,28 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Sets whether the container maintains an index of the data point value ranges, so that \ref
+  valueRange answers queries in logarithmic instead of linear time. This is useful for containers
+  with millions of data points that are frequently rescaled to (e.g. with \ref
+  QCustomPlot::rescaleAxes). By default this is disabled.
+
+  The index is a segment tree over blocks of data points. It uses a few bytes per data point and is
+  updated lazily on the next \ref valueRange call, only for the parts of the container that were
+  changed by \ref set, \ref add, \ref remove etc. If you modify data point values directly
+  through the non-const iterators (\ref begin, \ref end), call this method with \a enabled set to
+  true again, which rebuilds the index.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setValueRangeIndex(bool enabled)
+{
+  mValueRangeIndex = enabled;
+  mValueRangeTree.clear();
+  mValueRangeDirty.clear();
+  if (enabled)
+    invalidateValueRange(0, mData.size());
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2857,6 +2902,7 @@ void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool already
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
+  invalidateValueRange(0, (std::numeric_limits<int>::max)());
   if (!alreadySorted)
     sort();
 }
@@ -2882,12 +2928,17 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
       preallocateGrow(n);
     mPreallocSize -= n;
     std::copy(data.constBegin(), data.constEnd(), begin());
+    invalidateValueRange(mPreallocSize, mPreallocSize+n);
   } else // don't need to prepend, so append and merge if necessary
   {
     mData.resize(mData.size()+n);
     std::copy(data.constBegin(), data.constEnd(), end()-n);
+    invalidateValueRange(mData.size()-n, mData.size());
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+    {
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      invalidateValueRange(mPreallocSize, mData.size());
+    }
   }
 }
 
@@ -2919,14 +2970,19 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
       preallocateGrow(n);
     mPreallocSize -= n;
     std::copy(data.constBegin(), data.constEnd(), begin());
+    invalidateValueRange(mPreallocSize, mPreallocSize+n);
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
     mData.resize(mData.size()+n);
     std::copy(data.constBegin(), data.constEnd(), end()-n);
+    invalidateValueRange(mData.size()-n, mData.size());
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
       std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+    {
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      invalidateValueRange(mPreallocSize, mData.size());
+    }
   }
 }
 
@@ -2942,16 +2998,20 @@ void QCPDataContainer<DataType>::add(const DataType &data)
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
     mData.append(data);
+    invalidateValueRange(mData.size()-1, mData.size());
   } else if (qcpLessThanSortKey<DataType>(data, *constBegin()))  // quickly handle prepends using preallocated space
   {
     if (mPreallocSize < 1)
       preallocateGrow(1);
     --mPreallocSize;
     *begin() = data;
+    invalidateValueRange(mPreallocSize, mPreallocSize+1);
   } else // handle inserts, maintaining sorted keys
   {
     QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
+    const int insertionIndex = int(insertionPoint-mData.begin());
     mData.insert(insertionPoint, data);
+    invalidateValueRange(insertionIndex, mData.size());
   }
 }
 
@@ -2965,6 +3025,7 @@ void QCPDataContainer<DataType>::removeBefore(double sortKey)
 {
   QCPDataContainer<DataType>::iterator it = begin();
   QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  invalidateValueRange(mPreallocSize, mPreallocSize+int(itEnd-it));
   mPreallocSize += int(itEnd-it); // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2980,6 +3041,7 @@ void QCPDataContainer<DataType>::removeAfter(double sortKey)
 {
   QCPDataContainer<DataType>::iterator it = std::upper_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
   QCPDataContainer<DataType>::iterator itEnd = end();
+  invalidateValueRange(int(it-mData.begin()), mData.size());
   mData.erase(it, itEnd); // typically adds it to the postallocated block
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -3000,6 +3062,7 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
   
   QCPDataContainer<DataType>::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
   QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, end(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  invalidateValueRange(int(it-mData.begin()), mData.size());
   mData.erase(it, itEnd);
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -3020,6 +3083,7 @@ void QCPDataContainer<DataType>::remove(double sortKey)
   QCPDataContainer::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
   if (it != end() && it->sortKey() == sortKey)
   {
+    invalidateValueRange(int(it-mData.begin()), it == begin() ? mPreallocSize+1 : mData.size());
     if (it == begin())
       ++mPreallocSize; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
     else
@@ -3040,6 +3104,7 @@ void QCPDataContainer<DataType>::clear()
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
+  invalidateValueRange(0, (std::numeric_limits<int>::max)());
 }
 
 /*!
@@ -3057,6 +3122,7 @@ template <class DataType>
 void QCPDataContainer<DataType>::sort()
 {
   std::sort(begin(), end(), qcpLessThanSortKey<DataType>);
+  invalidateValueRange(mPreallocSize, mData.size());
 }
 
 /*!
@@ -3076,6 +3142,7 @@ void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation
   {
     if (mPreallocSize > 0)
     {
+      invalidateValueRange(0, mData.size());
       std::copy(begin(), end(), mData.begin());
       mData.resize(size());
       mPreallocSize = 0;
@@ -3086,6 +3153,20 @@ void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation
     mData.squeeze();
 }
 
+/*!
+  Allocates memory for at least \a size data points behind the current ones, so that appending up
+  to that many data points with \ref add doesn't reallocate and copy the container.
+
+  Together with \ref setAutoSqueeze set to false, this gives fixed-size blocks of data whose
+  appends and \ref removeBefore calls never move the existing data points, e.g. for splitting a
+  continuously growing data stream into a sequence of containers.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::reserve(int size)
+{
+  mData.reserve(mData.size()+size);
+}
+
 /*!
   Returns an iterator to the data point with a (sort-)key that is equal to, just below, or just
   above \a sortKey. If \a expandedRange is true, the data point just below \a sortKey will be
@@ -3300,7 +3381,17 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     itBegin = findBegin(inKeyRange.lower, false);
     itEnd = findEnd(inKeyRange.upper, false);
   }
-  if (signDomain == QCP::sdBoth) // range may be anywhere
+  if (mValueRangeIndex && (DataType::sortKeyIsMainKey() || !restrictKeyRange)) // iterators cover exactly the requested data, so the index can answer
+  {
+    updateValueRangeIndex();
+    const ValueRangeNode node = queryValueRange(int(itBegin-mData.constBegin()), int(itEnd-mData.constBegin()));
+    haveLower = node.lower[signDomain] != std::numeric_limits<double>::infinity();
+    haveUpper = node.upper[signDomain] != -std::numeric_limits<double>::infinity();
+    if (haveLower)
+      range.lower = node.lower[signDomain];
+    if (haveUpper)
+      range.upper = node.upper[signDomain];
+  } else if (signDomain == QCP::sdBoth) // range may be anywhere
   {
     for (QCPDataContainer<DataType>::const_iterator it = itBegin; it != itEnd; ++it)
     {
@@ -3397,6 +3488,7 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
   ++mPreallocIteration;
   
   int sizeDifference = newPreallocSize-mPreallocSize;
+  invalidateValueRange(0, mData.size()+sizeDifference);
   mData.resize(mData.size()+sizeDifference);
   std::copy_backward(mData.begin()+mPreallocSize, mData.end()-sizeDifference, mData.end());
   mPreallocSize = newPreallocSize;
@@ -3438,6 +3530,165 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
 
+/*! \internal
+  
+  Marks the value range index entries covering the indices \a begin to \a end of the internal
+  data vector (including the preallocation pool) as outdated. They are recalculated by the next
+  \ref updateValueRangeIndex. Passing the maximum int as \a end invalidates the whole index.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::invalidateValueRange(int begin, int end)
+{
+  if (!mValueRangeIndex || begin >= end)
+    return;
+  if (mValueRangeDirty.size() >= ValueRangeMaxDirty) // too many separate regions, merge them into one
+  {
+    for (int i=1; i<mValueRangeDirty.size(); ++i)
+    {
+      mValueRangeDirty.first().first = qMin(mValueRangeDirty.first().first, mValueRangeDirty.at(i).first);
+      mValueRangeDirty.first().second = qMax(mValueRangeDirty.first().second, mValueRangeDirty.at(i).second);
+    }
+    mValueRangeDirty.resize(1);
+  }
+  mValueRangeDirty.append(qMakePair(begin, end));
+}
+
+/*! \internal
+  
+  Recalculates the outdated leaves of the value range index and their parent nodes. If the data
+  has outgrown the index, it is rebuilt with a larger capacity.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::updateValueRangeIndex()
+{
+  if (mValueRangeDirty.isEmpty())
+    return;
+  
+  const int leafCount = qMax(1, (mData.size()+ValueRangeBlockSize-1)/ValueRangeBlockSize);
+  int capacity = mValueRangeTree.size()/2;
+  if (leafCount > capacity) // tree is a complete binary tree with leaves at indices capacity..2*capacity-1
+  {
+    capacity = 1;
+    while (capacity < leafCount)
+      capacity *= 2;
+    mValueRangeTree.fill(emptyValueRange(), 2*capacity);
+    mValueRangeDirty.clear();
+    mValueRangeDirty.append(qMakePair(0, (std::numeric_limits<int>::max)()));
+  }
+  
+  for (int d=0; d<mValueRangeDirty.size(); ++d)
+  {
+    const int firstLeaf = mValueRangeDirty.at(d).first/ValueRangeBlockSize;
+    const int lastLeaf = int(qMin(qint64(capacity), (qint64(mValueRangeDirty.at(d).second)+ValueRangeBlockSize-1)/ValueRangeBlockSize));
+    if (firstLeaf >= lastLeaf)
+      continue;
+    for (int leaf=firstLeaf; leaf<lastLeaf; ++leaf)
+      mValueRangeTree[capacity+leaf] = valueRangeOf(qMax(leaf*ValueRangeBlockSize, mPreallocSize), qMin((leaf+1)*ValueRangeBlockSize, mData.size()));
+    for (int lo=(capacity+firstLeaf)/2, hi=(capacity+lastLeaf-1)/2; lo >= 1; lo/=2, hi/=2)
+    {
+      for (int i=lo; i<=hi; ++i)
+        mValueRangeTree[i] = combineValueRange(mValueRangeTree.at(2*i), mValueRangeTree.at(2*i+1));
+    }
+  }
+  mValueRangeDirty.clear();
+}
+
+/*! \internal
+  
+  Returns the value ranges of the data points at the indices \a begin to \a end of the internal
+  data vector, applying the same filters (finite values, sign domains) as the linear search in
+  \ref valueRange.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::ValueRangeNode QCPDataContainer<DataType>::valueRangeOf(int begin, int end) const
+{
+  ValueRangeNode node = emptyValueRange();
+  for (int i=begin; i<end; ++i)
+  {
+    const QCPRange current = mData.at(i).valueRange();
+    if (!qIsNaN(current.lower) && std::isfinite(current.lower))
+    {
+      if (current.lower < node.lower[QCP::sdBoth])
+        node.lower[QCP::sdBoth] = current.lower;
+      if (current.lower < 0 && current.lower < node.lower[QCP::sdNegative])
+        node.lower[QCP::sdNegative] = current.lower;
+      if (current.lower > 0 && current.lower < node.lower[QCP::sdPositive])
+        node.lower[QCP::sdPositive] = current.lower;
+    }
+    if (!qIsNaN(current.upper) && std::isfinite(current.upper))
+    {
+      if (current.upper > node.upper[QCP::sdBoth])
+        node.upper[QCP::sdBoth] = current.upper;
+      if (current.upper < 0 && current.upper > node.upper[QCP::sdNegative])
+        node.upper[QCP::sdNegative] = current.upper;
+      if (current.upper > 0 && current.upper > node.upper[QCP::sdPositive])
+        node.upper[QCP::sdPositive] = current.upper;
+    }
+  }
+  return node;
+}
+
+/*! \internal
+  
+  Returns the value ranges of the data points at the indices \a begin to \a end of the internal
+  data vector, using the (up to date) value range index for all complete blocks in between.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::ValueRangeNode QCPDataContainer<DataType>::queryValueRange(int begin, int end) const
+{
+  const int headEnd = qMin(end, (begin+ValueRangeBlockSize-1)/ValueRangeBlockSize*ValueRangeBlockSize);
+  ValueRangeNode left = valueRangeOf(begin, headEnd);
+  if (headEnd >= end)
+    return left;
+  const int tailBegin = qMax(headEnd, end/ValueRangeBlockSize*ValueRangeBlockSize);
+  ValueRangeNode right = valueRangeOf(tailBegin, end);
+  
+  const int capacity = mValueRangeTree.size()/2;
+  for (int lo=capacity+headEnd/ValueRangeBlockSize, hi=capacity+tailBegin/ValueRangeBlockSize; lo < hi; lo/=2, hi/=2)
+  {
+    if (lo & 1)
+      left = combineValueRange(left, mValueRangeTree.at(lo++));
+    if (hi & 1)
+      right = combineValueRange(mValueRangeTree.at(--hi), right);
+  }
+  return combineValueRange(left, right);
+}
+
+/*! \internal
+  
+  Returns the value range node of an empty set of data points.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::ValueRangeNode QCPDataContainer<DataType>::emptyValueRange()
+{
+  ValueRangeNode node;
+  for (int d=0; d<3; ++d)
+  {
+    node.lower[d] = std::numeric_limits<double>::infinity();
+    node.upper[d] = -std::numeric_limits<double>::infinity();
+  }
+  return node;
+}
+
+/*! \internal
+  
+  Combines the value range nodes of two adjacent sets of data points, \a a preceding \a b. On
+  ties, the value of \a a is kept, like the linear search in \ref valueRange does.
+*/
+template <class DataType>
+typename QCPDataContainer<DataType>::ValueRangeNode QCPDataContainer<DataType>::combineValueRange(const ValueRangeNode &a, const ValueRangeNode &b)
+{
+  ValueRangeNode node = a;
+  for (int d=0; d<3; ++d)
+  {
+    if (b.lower[d] < node.lower[d])
+      node.lower[d] = b.lower[d];
+    if (b.upper[d] > node.upper[d])
+      node.upper[d] = b.upper[d];
+  }
+  return node;
+}
+
 
 /* end of 'src/datacontainer.h' */
 
@@ -5568,6 +5819,10 @@ protected:
   virtual void getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const;
   
   // non-virtual methods:
+  QCPGraphDataContainer::const_iterator getAdaptiveLineData(QVector<QCPGraphData> *lineData, QVector<QPair<int, int> > *intervalStarts, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &from, const QCPGraphDataContainer::const_iterator &stop, const QCPGraphDataContainer::const_iterator &end, double keyEpsilon) const;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+  void getParallelAdaptiveLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, double keyEpsilon, int chunkCount) const;
+#endif
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
@@ -0,0 +1,909 @@
+#include "ColumnSeries.h"
+#include "DecimatedGraph.h"
+#include "FunctionSampler.h"
+#include "Interval.h"
+#include "MappedSeries.h"
+#include "Parser.h"
+#include "VectorMath.h"
+#include "graphicwidget.h"
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+
+namespace {
+
+// Значения совпадают с точностью до округления
+bool closeTo(double actual, double expected)
+{
+    return std::abs(actual - expected) <= 1e-12 * std::max(1.0, std::abs(expected));
+}
+
+// Диапазон значений полным перебором: то, что индексы должны дать быстрее
+QCPRange scanRange(const QVector<double>& values, int from, int to, bool& found)
+{
+    QCPRange range;
+    found = false;
+    for (int i = from; i < to; ++i)
+    {
+        const double value = values.at(i);
+        if (!std::isfinite(value))
+            continue;
+        if (!found)
+            range = QCPRange(value, value);
+        range.lower = std::min(range.lower, value);
+        range.upper = std::max(range.upper, value);
+        found = true;
+    }
+    return range;
+}
+
+// Ошибка в единицах последнего разряда double относительно более точного
+// значения; нули, бесконечности и NaN должны совпасть в точности
+double ulpError(double actual, long double expected)
+{
+    const double rounded = double(expected);
+    if (std::isnan(rounded) || std::isinf(rounded) || rounded == 0.0)
+        return actual == rounded || (std::isnan(actual) && std::isnan(rounded)) ? 0.0 : qInf();
+    const double ulp = std::ldexp(1.0, std::max(std::ilogb(rounded), DBL_MIN_EXP - 1) - 52);
+    return double(std::abs(actual - expected) / ulp);
+}
+
+// Функция VectorMath, её эталон и область, где действует оценка погрешности
+struct VectorFunction {
+    void (*batch)(const double*, double*, int);
+    long double (*reference)(long double);
+    double (*scalar)(double);
+    double minArgument;
+    double maxArgument;
+    double maxUlp;
+};
+
+VectorFunction vectorFunction(const QString& name)
+{
+    // Границы — из VectorMath.h
+    if (name == "sin")
+        return {VectorMath::sin, [](long double x) { return std::sin(x); }, [](double x) { return std::sin(x); },
+                -1e5, 1e5, 1.0};
+    if (name == "cos")
+        return {VectorMath::cos, [](long double x) { return std::cos(x); }, [](double x) { return std::cos(x); },
+                -1e5, 1e5, 1.0};
+    if (name == "tan")
+        return {VectorMath::tan, [](long double x) { return std::tan(x); }, [](double x) { return std::tan(x); },
+                -1e5, 1e5, 2.5};
+    if (name == "exp")
+        return {VectorMath::exp, [](long double x) { return std::exp(x); }, [](double x) { return std::exp(x); },
+                -708.0, 708.0, 1.0};
+    return {VectorMath::log, [](long double x) { return std::log(x); }, [](double x) { return std::log(x); },
+            DBL_MIN, DBL_MAX, 1.0};
+}
+
+// Доступ к адаптивной выборке QCPGraph: последовательной и параллельной
+class AdaptiveProbe : public QCPGraph
+{
+public:
+    AdaptiveProbe(QCPAxis* keyAxis, QCPAxis* valueAxis) : QCPGraph(keyAxis, valueAxis) {}
+
+    // Ширина пикселя в ключах у первой точки — как в getOptimizedLineData
+    double keyEpsilon() const
+    {
+        const QCPAxis* axis = keyAxis();
+        const int reversedFactor = axis->pixelOrientation();
+        const int reversedRound = reversedFactor == -1 ? 1 : 0;
+        const double firstKey = axis->pixelToCoord(int(axis->coordToPixel(data()->constBegin()->key) + reversedRound));
+        return qAbs(firstKey - axis->pixelToCoord(axis->coordToPixel(firstKey) + 1.0 * reversedFactor));
+    }
+    QVector<QCPGraphData> serial() const
+    {
+        QVector<QCPGraphData> lineData;
+        getAdaptiveLineData(&lineData, nullptr, data()->constBegin(), data()->constBegin(),
+                            data()->constEnd(), data()->constEnd(), keyEpsilon());
+        return lineData;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    QVector<QCPGraphData> parallel(int chunkCount) const
+    {
+        QVector<QCPGraphData> lineData;
+        getParallelAdaptiveLineData(&lineData, data()->constBegin(), data()->constEnd(), keyEpsilon(), chunkCount);
+        return lineData;
+    }
+#endif
+};
+
+// Прореженная линия DecimatedGraph для точек контейнера from..to-1
+class DecimatedProbe : public DecimatedGraph
+{
+public:
+    DecimatedProbe(QCPAxis* keyAxis, QCPAxis* valueAxis) : DecimatedGraph(keyAxis, valueAxis) {}
+
+    QVector<QCPGraphData> lineData(int from, int to) const
+    {
+        QVector<QCPGraphData> lineData;
+        getOptimizedLineData(&lineData, data()->constBegin() + from, data()->constBegin() + to);
+        return lineData;
+    }
+};
+
+// Прореженная линия против полного перебора по столбцам пикселей: наименьшее
+// и наибольшее значения столбца и его разрывы (NaN) должны найтись среди
+// выданных точек этого или соседнего столбца — корзина уже пикселя, но может
+// задеть два столбца. Выдаваться могут только исходные точки, по возрастанию
+// ключей. Пустая строка — всё сходится
+QString checkEnvelope(const QVector<QCPGraphData>& line, const QCPGraphData* from, const QCPGraphData* to,
+                      const QCPAxis* keyAxis)
+{
+    struct Column {
+        double min = qInf();
+        double max = -qInf();
+        bool nan = false;
+    };
+    auto columnOf = [keyAxis](double key) { return int(std::floor(keyAxis->coordToPixel(key))); };
+    auto add = [](Column& column, double value) {
+        if (std::isnan(value))
+            column.nan = true;
+        column.min = std::fmin(column.min, value);
+        column.max = std::fmax(column.max, value);
+    };
+
+    const int first = columnOf(from->key);
+    QVector<Column> raw(columnOf((to - 1)->key) - first + 1);
+    QVector<Column> drawn(raw.size());
+    for (const QCPGraphData* point = from; point != to; ++point)
+        add(raw[columnOf(point->key) - first], point->value);
+
+    double previousKey = -qInf();
+    for (const QCPGraphData& point : line)
+    {
+        const QCPGraphData* source = std::lower_bound(from, to, point.key,
+                                                      [](const QCPGraphData& d, double k) { return d.key < k; });
+        const bool sameValue = source != to &&
+                               (source->value == point.value || (std::isnan(source->value) && std::isnan(point.value)));
+        if (!sameValue || source->key != point.key || point.key <= previousKey)
+            return QString("Лишняя точка с ключом %1").arg(point.key, 0, 'g', 17);
+        previousKey = point.key;
+        add(drawn[columnOf(point.key) - first], point.value);
+    }
+
+    for (int c = 0; c < raw.size(); ++c)
+    {
+        Column neighbours;
+        for (int k = std::max(c - 1, 0); k <= std::min(c + 1, int(raw.size()) - 1); ++k)
+        {
+            neighbours.min = std::fmin(neighbours.min, drawn[k].min);
+            neighbours.max = std::fmax(neighbours.max, drawn[k].max);
+            neighbours.nan = neighbours.nan || drawn[k].nan;
+        }
+        if (raw[c].min < neighbours.min || raw[c].max > neighbours.max || (raw[c].nan && !neighbours.nan))
+            return QString("Столбец %1: [%2, %3] вместо [%4, %5]")
+                .arg(first + c).arg(neighbours.min).arg(neighbours.max).arg(raw[c].min).arg(raw[c].max);
+    }
+    return QString();
+}
+
+} // namespace
+
+class TestGraphicEditor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseEvaluate_data();
+    void parseEvaluate();
+    void parseRejects_data();
+    void parseRejects();
+    void exactPower();
+    void cotangentPoles();
+    void coefficients();
+    void parserCache();
+    void vectorMathAccuracy_data();
+    void vectorMathAccuracy();
+    void intervalContainment_data();
+    void intervalContainment();
+    void sampledValueRange();
+    void fitYRange();
+    void valueRangeIndex();
+    void columnSeriesSearch();
+    void mappedSeriesRoundTrip();
+    void parallelAdaptiveSampling_data();
+    void parallelAdaptiveSampling();
+    void decimatedEnvelope();
+    void mappedSeriesCorruptHeader_data();
+    void mappedSeriesCorruptHeader();
+};
+
+void TestGraphicEditor::parseEvaluate_data()
+{
+    QTest::addColumn<QString>("expression");
+    QTest::addColumn<double>("x");
+    QTest::addColumn<double>("expected");
+
+    const double x = 0.7;
+    QTest::newRow("polynomial") << "3*x^2 - 2*x + 1" << x << 3 * x * x - 2 * x + 1;
+    QTest::newRow("implicit product") << "2x" << x << 2 * x;
+    QTest::newRow("constants") << "pi*x" << x << M_PI * x;
+    QTest::newRow("rational") << "(x+1)^2/x" << x << (x + 1) * (x + 1) / x;
+    QTest::newRow("product") << "x*sin(x)" << x << x * std::sin(x);
+    QTest::newRow("trigonometric") << "tan(x)/2 - cot(x)" << x << std::tan(x) / 2 - 1 / std::tan(x);
+    QTest::newRow("exponential") << "exp(x/2)*cos(3*x)" << x << std::exp(x / 2) * std::cos(3 * x);
+    QTest::newRow("logarithm") << "ln(x^2+1)" << x << std::log(x * x + 1);
+    QTest::newRow("log base") << "log_2(x+6)" << x << std::log2(x + 6);
+    QTest::newRow("modulus") << "|2*x-3|+1" << x << std::abs(2 * x - 3) + 1;
+    QTest::newRow("root") << "sqrt(|x|)" << -x << std::sqrt(x);
+    QTest::newRow("power") << "2^x - x^0.5" << x << std::pow(2.0, x) - std::sqrt(x);
+    // Не раскрывается в многочлен: у корня коэффициенты сократились бы с потерей точности
+    QTest::newRow("high power") << "(x-3)^30" << 3.5 << std::pow(0.5, 30);
+    QTest::newRow("high product") << "(x-3)^10*(x-3)^10" << 3.5 << std::pow(0.5, 20);
+    QTest::newRow("low power") << "(x-3)^2*(x+1)" << 3.5 << 0.25 * 4.5;
+}
+
+void TestGraphicEditor::parseEvaluate()
+{
+    QFETCH(QString, expression);
+    QFETCH(double, x);
+    QFETCH(double, expected);
+
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse(expression));
+    QVERIFY(func);
+    QVERIFY2(closeTo(func->evaluate(x), expected), qPrintable(QString::number(func->evaluate(x), 'g', 17)));
+
+    // Пакетное вычисление идёт другими ядрами, но должно давать то же
+    const double xs[3] = {x, x, x};
+    double ys[3];
+    func->evaluate(xs, ys, 3);
+    for (double y : ys)
+        QVERIFY2(closeTo(y, expected), qPrintable(QString::number(y, 'g', 17)));
+}
+
+void TestGraphicEditor::parseRejects_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("empty") << "";
+    QTest::newRow("unclosed") << "sin(";
+    QTest::newRow("dangling operator") << "x+";
+    QTest::newRow("missing operand") << "1/";
+    QTest::newRow("unknown function") << "foo(x)";
+    // Пробел разделяет лексемы, а не пропадает
+    QTest::newRow("separated numbers") << "2 3";
+    QTest::newRow("separated name") << "co s(x)";
+}
+
+void TestGraphicEditor::parseRejects()
+{
+    QFETCH(QString, expression);
+
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse(expression));
+    QVERIFY(!func);
+    QVERIFY(!ParserCache::instance().parse(expression));
+}
+
+void TestGraphicEditor::exactPower()
+{
+    // Степень постоянного основания без exp(u * ln c): целые степени точны
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse("2^(x+1) + 10^x"));
+    QVERIFY(func);
+    QCOMPARE(func->evaluate(2.0), 108.0);
+    const double xs[2] = {2.0, -1.0};
+    double ys[2];
+    func->evaluate(xs, ys, 2);
+    QVERIFY(ys[0] == 108.0);
+    QVERIFY(ys[1] == 1.0 + 0.1);
+}
+
+void TestGraphicEditor::cotangentPoles()
+{
+    // cot внутри выражения (байт-код) и в свёртке констант: в полюсе NaN, а не 0
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse("x + cot(x)"));
+    QVERIFY(func);
+    QVERIFY(std::isnan(func->evaluate(0.0)));
+    const double xs[2] = {0.0, 1.0};
+    double ys[2];
+    func->evaluate(xs, ys, 2);
+    QVERIFY(std::isnan(ys[0]));
+    QVERIFY(closeTo(ys[1], 1.0 + 1.0 / std::tan(1.0)));
+
+    std::unique_ptr<Function> folded(parser.parse("x + cot(0)"));
+    QVERIFY(folded);
+    QVERIFY(std::isnan(folded->evaluate(1.0)));
+}
+
+void TestGraphicEditor::coefficients()
+{
+    // 1/ln 2 и 1/4 получены упрощением и в коэффициенты не входят
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse("2^x + log_2(x) + x/4 - 3*x"));
+    QVERIFY(func);
+    QCOMPARE(func->getCoefficients(), QVector<double>({2.0, 3.0}));
+
+    func->setCoefficients({3.0, 1.0});
+    QVERIFY(closeTo(func->evaluate(2.0), 9.0 + 1.0 + 0.5 - 2.0));
+}
+
+void TestGraphicEditor::parserCache()
+{
+    ParserCache& cache = ParserCache::instance();
+    const std::shared_ptr<const Function> first = cache.parse("2*x + 1");
+    QVERIFY(first);
+    // Запись отличается только регистром и пробелами — та же функция
+    QCOMPARE(cache.parse(" 2*X  +  1 ").get(), first.get());
+    QVERIFY(cache.parse("2*x + 2").get() != first.get());
+}
+
+void TestGraphicEditor::vectorMathAccuracy_data()
+{
+    QTest::addColumn<int>("isa");
+    QTest::addColumn<QString>("function");
+
+    const QPair<VectorMath::Isa, const char*> isas[] = {qMakePair(VectorMath::Sse2, "sse2"),
+                                                        qMakePair(VectorMath::Avx2, "avx2")};
+    for (const auto& isa : isas)
+    {
+        for (const char* function : {"sin", "cos", "tan", "exp", "log"})
+            QTest::newRow(qPrintable(QString("%1 %2").arg(isa.second, function))) << int(isa.first) << QString(function);
+    }
+}
+
+void TestGraphicEditor::vectorMathAccuracy()
+{
+    QFETCH(int, isa);
+    QFETCH(QString, function);
+
+    const VectorMath::Isa previous = VectorMath::activeIsa();
+    if (!VectorMath::setActiveIsa(VectorMath::Isa(isa)))
+        QSKIP("Набор инструкций не поддерживается");
+    struct Restore {
+        VectorMath::Isa isa;
+        ~Restore() { VectorMath::setActiveIsa(isa); }
+    } restore = {previous};
+
+    const VectorFunction f = vectorFunction(function);
+    const double inf = qInf();
+    const double denormal = std::numeric_limits<double>::denorm_min();
+    QVector<double> xs = {0.0, -0.0, inf, -inf, qQNaN(), denormal, -denormal, DBL_MIN, 1.0, -1.0,
+                          1.0 + DBL_EPSILON, 1.0 - DBL_EPSILON / 2, 709.0, -709.0, 710.0, -745.5,
+                          1e6, -1e6, 1e22, -1e22, 1e300, -1e300, DBL_MAX, -DBL_MAX};
+    // Равномерно по области и по порядкам величины, плюс окрестности k*pi/2
+    std::mt19937_64 random(5);
+    const bool positive = f.minArgument > 0.0;
+    std::uniform_real_distribution<double> uniform(positive ? 0.0 : f.minArgument, positive ? 4.0 : f.maxArgument);
+    std::uniform_real_distribution<double> exponent(-300.0, std::log10(f.maxArgument));
+    for (int i = 0; i < 100000; ++i)
+    {
+        xs.append(uniform(random));
+        const double magnitude = std::pow(10.0, exponent(random));
+        xs.append(positive || random() % 2 ? magnitude : -magnitude);
+    }
+    for (int k = -2000; k <= 2000; ++k)
+        xs.append(std::nextafter(k * M_PI_2, 0.0));
+
+    QVector<double> ys(xs.size());
+    f.batch(xs.constData(), ys.data(), xs.size());
+
+    // Эталон — long double libm; если long double не точнее double, сам
+    // эталон ошибается на полразряда и допуск расширяется
+    const double slack = std::numeric_limits<long double>::digits > std::numeric_limits<double>::digits ? 0.0 : 1.0;
+    for (int i = 0; i < xs.size(); ++i)
+    {
+        const double x = xs[i];
+        if (std::isfinite(x) && x >= f.minArgument && x <= f.maxArgument)
+        {
+            const double error = ulpError(ys[i], f.reference(x));
+            QVERIFY2(error <= f.maxUlp + slack,
+                     qPrintable(QString("%1(%2) = %3, %4 ulp").arg(function).arg(x, 0, 'g', 17)
+                                .arg(ys[i], 0, 'g', 17).arg(error)));
+        }
+        else
+        {
+            // Вне области — ровно то, что даёт скалярный libm
+            const double expected = f.scalar(x);
+            QVERIFY2(std::memcmp(&ys[i], &expected, sizeof(double)) == 0 || (std::isnan(ys[i]) && std::isnan(expected)),
+                     qPrintable(QString("%1(%2) = %3 вместо %4").arg(function).arg(x, 0, 'g', 17)
+                                .arg(ys[i], 0, 'g', 17).arg(expected, 0, 'g', 17)));
+        }
+    }
+}
+
+void TestGraphicEditor::intervalContainment_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("polynomial") << "x^3 - 4*x + 1";
+    QTest::newRow("product") << "x*sin(x)";
+    QTest::newRow("tangent") << "tan(x)";
+    QTest::newRow("cotangent") << "2*cot(3*x+1)";
+    QTest::newRow("exponential") << "exp(x/2)*cos(3*x)";
+    QTest::newRow("logarithm") << "ln(x^2+1) - log_2(|x|+1)";
+    QTest::newRow("root") << "sqrt(|x|) - 1/(x^2+1)";
+    QTest::newRow("modulus") << "|2*x-3| + |sin(x)|";
+    QTest::newRow("power") << "2^x - x^2";
+}
+
+void TestGraphicEditor::intervalContainment()
+{
+    QFETCH(QString, expression);
+
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse(expression));
+    QVERIFY(func);
+
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> center(-20.0, 20.0);
+    std::uniform_real_distribution<double> width(-6.0, 1.0);
+    const int Samples = 64;
+    for (int trial = 0; trial < 1000; ++trial)
+    {
+        const double lower = center(random);
+        const double upper = lower + std::pow(10.0, width(random));
+        const Interval bounds = func->bounds(lower, upper);
+        // Недействительный интервал — оценки нет, проверять нечего
+        if (!bounds.isValid())
+            continue;
+        // Запас на округление, как у самих границ
+        const double slack = 1e-9 * std::max({1.0, std::abs(bounds.lower), std::abs(bounds.upper)});
+        for (int i = 0; i <= Samples; ++i)
+        {
+            const double x = lower + (upper - lower) * i / Samples;
+            const double y = func->evaluate(x);
+            if (std::isnan(y))
+                continue;
+            QVERIFY2(bounds.lower - slack <= y && y <= bounds.upper + slack,
+                     qPrintable(QString("f(%1) = %2 вне [%3, %4]")
+                                .arg(x, 0, 'g', 17).arg(y, 0, 'g', 17)
+                                .arg(bounds.lower, 0, 'g', 17).arg(bounds.upper, 0, 'g', 17)));
+        }
+    }
+}
+
+void TestGraphicEditor::sampledValueRange()
+{
+    ExpressionParser parser;
+    std::unique_ptr<Function> func(parser.parse("x*sin(x) + tan(x/3)"));
+    QVERIFY(func);
+
+    std::mt19937_64 random(5);
+    std::uniform_real_distribution<double> center(-50.0, 50.0);
+    std::uniform_real_distribution<double> width(0.1, 20.0);
+    for (int trial = 0; trial < 100; ++trial)
+    {
+        const double lower = center(random);
+        const double upper = lower + width(random);
+        bool found = false;
+        const QCPRange range = FunctionSampler::valueRange(*func, lower, upper, found);
+        QVERIFY(found);
+        const double slack = 1e-9 * std::max({1.0, std::abs(range.lower), std::abs(range.upper)});
+        // Части с полюсом пропускаются, поэтому сверяются точки только
+        // тех частей, где оценка есть
+        const double piece = (upper - lower) / FunctionSampler::BoundPieces;
+        for (int i = 0; i < FunctionSampler::BoundPieces; ++i)
+        {
+            const double x0 = lower + i * piece;
+            if (!func->bounds(x0, x0 + piece).isValid())
+                continue;
+            for (double x : {x0, x0 + piece / 2})
+            {
+                const double y = func->evaluate(x);
+                QVERIFY(range.lower - slack <= y && y <= range.upper + slack);
+            }
+        }
+    }
+}
+
+void TestGraphicEditor::fitYRange()
+{
+    GraphicWidget widget;
+    QCustomPlot* plot = widget.findChild<QCustomPlot*>();
+    QVERIFY(plot);
+
+    ExpressionParser parser;
+    widget.addFunction(parser.parse("x^2 - 1"));
+    widget.addFunction(parser.parse("-x"));
+    widget.setXRange(-2.0, 3.0);
+    widget.fitYRange();
+    // На [-2, 3]: x^2 - 1 от -1 до 8, -x от -3 до 2
+    const QCPRange range = plot->yAxis->range();
+    QVERIFY(range.lower <= -3.0 && range.lower > -3.5);
+    QVERIFY(range.upper >= 8.0 && range.upper < 8.5);
+
+    // Постоянной функции нужен ненулевой диапазон
+    widget.clearFunctions();
+    widget.addFunction(parser.parse("2"));
+    widget.fitYRange();
+    QCOMPARE(plot->yAxis->range().lower, 1.0);
+    QCOMPARE(plot->yAxis->range().upper, 3.0);
+}
+
+void TestGraphicEditor::valueRangeIndex()
+{
+    // Один и тот же ряд с деревом отрезков по значениям и без него
+    QCPGraphDataContainer indexed, linear;
+    indexed.setValueRangeIndex(true);
+
+    std::mt19937_64 random(2);
+    std::uniform_real_distribution<double> key(0.0, 1000.0);
+    std::uniform_real_distribution<double> value(-100.0, 100.0);
+    std::uniform_int_distribution<int> operation(0, 9);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const QCP::SignDomain domains[] = {QCP::sdBoth, QCP::sdNegative, QCP::sdPositive};
+
+    for (int step = 0; step < 300; ++step)
+    {
+        const int op = operation(random);
+        if (op < 5)
+        {
+            QVector<QCPGraphData> points;
+            for (int i = 0; i < 50; ++i)
+                points.append(QCPGraphData(key(random), i % 17 == 0 ? nan : value(random)));
+            indexed.add(points);
+            linear.add(points);
+        }
+        else if (op == 5)
+        {
+            const QCPGraphData point(key(random), value(random));
+            indexed.add(point);
+            linear.add(point);
+        }
+        else if (op == 6)
+        {
+            const double before = key(random) / 10;
+            indexed.removeBefore(before);
+            linear.removeBefore(before);
+        }
+        else if (op == 7)
+        {
+            const double after = 1000.0 - key(random) / 10;
+            indexed.removeAfter(after);
+            linear.removeAfter(after);
+        }
+        else if (op == 8)
+        {
+            const double from = key(random), to = from + key(random) / 20;
+            indexed.remove(from, to);
+            linear.remove(from, to);
+        }
+        else
+        {
+            QVector<QCPGraphData> points;
+            for (int i = 0; i < 200; ++i)
+                points.append(QCPGraphData(key(random), value(random)));
+            indexed.set(points);
+            linear.set(points);
+        }
+        QCOMPARE(indexed.size(), linear.size());
+
+        for (int query = 0; query < 10; ++query)
+        {
+            double from = key(random), to = key(random);
+            if (from > to)
+                std::swap(from, to);
+            const QCPRange inKeyRange = query == 0 ? QCPRange() : QCPRange(from, to);
+            for (QCP::SignDomain domain : domains)
+            {
+                bool foundIndexed = false, foundLinear = false;
+                const QCPRange a = indexed.valueRange(foundIndexed, domain, inKeyRange);
+                const QCPRange b = linear.valueRange(foundLinear, domain, inKeyRange);
+                QCOMPARE(foundIndexed, foundLinear);
+                if (foundLinear)
+                {
+                    QCOMPARE(a.lower, b.lower);
+                    QCOMPARE(a.upper, b.upper);
+                }
+            }
+        }
+    }
+}
+
+void TestGraphicEditor::columnSeriesSearch()
+{
+    std::mt19937_64 random(3);
+    std::uniform_int_distribution<int> key(0, 200);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+
+    // Повторяющиеся ключи и несортированный ввод
+    QVector<double> keys, values;
+    for (int i = 0; i < 2000; ++i)
+    {
+        keys.append(key(random) * 0.5);
+        values.append(i % 31 == 0 ? std::numeric_limits<double>::quiet_NaN() : value(random));
+    }
+    ColumnSeries series;
+    series.set(keys, values);
+    QCOMPARE(series.size(), keys.size());
+
+    const QVector<double>& sorted = series.keys();
+    QVERIFY(std::is_sorted(sorted.begin(), sorted.end()));
+    // Ключи кратны 0.5: пробы попадают и в ключи, и между ними
+    for (int k = -4; k <= 404; ++k)
+    {
+        const double probe = k * 0.25;
+        const int lower = int(std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+        const int upper = int(std::upper_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+        QCOMPARE(series.findBegin(probe, false), lower);
+        QCOMPARE(series.findEnd(probe, false), upper);
+        QCOMPARE(series.findBegin(probe, true), std::max(lower - 1, 0));
+        QCOMPARE(series.findEnd(probe, true), std::min(upper + 1, series.size()));
+    }
+
+    std::uniform_int_distribution<int> index(0, series.size());
+    for (int query = 0; query < 500; ++query)
+    {
+        int from = index(random), to = index(random);
+        if (from > to)
+            std::swap(from, to);
+        bool found = false, foundScan = false;
+        const QCPRange range = series.valueRange(from, to, found);
+        const QCPRange expected = scanRange(series.values(), from, to, foundScan);
+        QCOMPARE(found, foundScan);
+        if (foundScan)
+        {
+            QCOMPARE(range.lower, expected.lower);
+            QCOMPARE(range.upper, expected.upper);
+        }
+    }
+}
+
+void TestGraphicEditor::mappedSeriesRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath("series.bin");
+
+    // Несколько уровней сводок и неполная последняя сводка
+    const int Count = MappedSeriesWriter::BlockPoints * MappedSeriesWriter::LevelFactor * 3 + 123;
+    std::mt19937_64 random(4);
+    std::uniform_real_distribution<double> value(-1e3, 1e3);
+    QVector<double> keys, values;
+    {
+        MappedSeriesWriter writer(fileName);
+        QVERIFY(writer.open());
+        double key = -50.0;
+        for (int i = 0; i < Count; ++i)
+        {
+            key += (i % 5 == 0) ? 0.0 : 0.01;
+            keys.append(key);
+            values.append(i % 1000 == 0 ? std::numeric_limits<double>::quiet_NaN() : value(random));
+            QVERIFY(writer.append(keys.last(), values.last()));
+        }
+        // Ключи не должны убывать
+        QVERIFY(!writer.append(key - 1.0, 0.0));
+        QVERIFY(writer.close());
+    }
+
+    QString error;
+    const std::shared_ptr<const MappedSeries> series = MappedSeries::open(fileName, &error);
+    QVERIFY2(series, qPrintable(error));
+    QCOMPARE(series->size(), qint64(Count));
+    for (int i = 0; i < Count; ++i)
+    {
+        QCOMPARE(series->data()[i].key, keys.at(i));
+        if (std::isnan(values.at(i)))
+            QVERIFY(std::isnan(series->data()[i].value));
+        else
+            QCOMPARE(series->data()[i].value, values.at(i));
+    }
+    QCOMPARE(series->keyRange().lower, keys.first());
+    QCOMPARE(series->keyRange().upper, keys.last());
+
+    std::uniform_int_distribution<int> index(0, Count - 1);
+    for (int query = 0; query < 500; ++query)
+    {
+        const double probe = keys.at(index(random));
+        QCOMPARE(series->lowerBound(probe), qint64(std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin()));
+        QCOMPARE(series->upperBound(probe), qint64(std::upper_bound(keys.begin(), keys.end(), probe) - keys.begin()));
+
+        int from = index(random), to = index(random) + 1;
+        if (from > to)
+            std::swap(from, to);
+        bool found = false, foundScan = false;
+        const QCPRange range = series->valueRange(from, to, found);
+        const QCPRange expected = scanRange(values, from, to, foundScan);
+        QCOMPARE(found, foundScan);
+        if (foundScan)
+        {
+            QCOMPARE(range.lower, expected.lower);
+            QCOMPARE(range.upper, expected.upper);
+        }
+    }
+}
+
+void TestGraphicEditor::parallelAdaptiveSampling_data()
+{
+    QTest::addColumn<bool>("logarithmic");
+    QTest::addColumn<bool>("reversed");
+    QTest::addColumn<bool>("gaps");
+
+    QTest::newRow("linear") << false << false << false;
+    QTest::newRow("linear, gaps") << false << false << true;
+    QTest::newRow("reversed") << false << true << false;
+    QTest::newRow("logarithmic") << true << false << false;
+    QTest::newRow("logarithmic, reversed, gaps") << true << true << true;
+}
+
+void TestGraphicEditor::parallelAdaptiveSampling()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    QFETCH(bool, logarithmic);
+    QFETCH(bool, reversed);
+    QFETCH(bool, gaps);
+
+    QCustomPlot plot;
+    plot.setViewport(QRect(0, 0, 800, 600));
+    if (logarithmic)
+        plot.xAxis->setScaleType(QCPAxis::stLogarithmic);
+    plot.xAxis->setRangeReversed(reversed);
+    AdaptiveProbe* graph = new AdaptiveProbe(plot.xAxis, plot.yAxis);
+
+    // Неравномерные ключи с повторами, случайное блуждание значений,
+    // участки NaN
+    std::mt19937_64 random(7);
+    std::exponential_distribution<double> step(1.0);
+    std::normal_distribution<double> walk(0.0, 1.0);
+    std::uniform_int_distribution<int> gapStart(0, 999);
+    const int Count = 300000;
+    QVector<QCPGraphData> points;
+    points.reserve(Count);
+    double key = 1.0;
+    double value = 0.0;
+    int gapLeft = 0;
+    for (int i = 0; i < Count; ++i)
+    {
+        if (i % 97 != 0)
+            key += step(random) * 1e-3;
+        value += walk(random);
+        if (gaps && gapLeft == 0 && gapStart(random) == 0)
+            gapLeft = 50;
+        const bool nan = gapLeft > 0;
+        if (nan)
+            --gapLeft;
+        points.append(QCPGraphData(key, nan ? std::numeric_limits<double>::quiet_NaN() : value));
+    }
+    graph->data()->set(points, true);
+    plot.xAxis->setRange(1.0, key);
+    plot.replot();
+
+    const QVector<QCPGraphData> serial = graph->serial();
+    QVERIFY(serial.size() < Count / 10);
+    for (int chunks : {2, 3, 4, 7, 16})
+    {
+        const QVector<QCPGraphData> parallel = graph->parallel(chunks);
+        QCOMPARE(parallel.size(), serial.size());
+        // Побитовое совпадение, включая NaN
+        QVERIFY2(std::memcmp(parallel.constData(), serial.constData(), serial.size() * sizeof(QCPGraphData)) == 0,
+                 qPrintable(QString("%1 кусков").arg(chunks)));
+    }
+#else
+    QSKIP("Параллельная выборка требует Qt 5.9");
+#endif
+}
+
+void TestGraphicEditor::decimatedEnvelope()
+{
+    QCustomPlot plot;
+    plot.setViewport(QRect(0, 0, 800, 600));
+    DecimatedProbe* graph = new DecimatedProbe(plot.xAxis, plot.yAxis);
+
+    // Равномерные ключи: при них корзина выбранного уровня уже пикселя
+    std::mt19937_64 random(11);
+    std::normal_distribution<double> walk(0.0, 1.0);
+    std::uniform_int_distribution<int> gapStart(0, 1999);
+    double key = 0.0;
+    double value = 0.0;
+    int gapLeft = 0;
+    auto append = [&](int count) {
+        QVector<QCPGraphData> points;
+        points.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            value += walk(random);
+            if (gapLeft == 0 && gapStart(random) == 0)
+                gapLeft = 20;
+            const bool nan = gapLeft > 0;
+            if (nan)
+                --gapLeft;
+            points.append(QCPGraphData(key, nan ? std::numeric_limits<double>::quiet_NaN() : value));
+            key += 1.0;
+        }
+        graph->data()->add(points, true);
+    };
+
+    append(200000);
+    plot.xAxis->setRange(0.0, key);
+    plot.replot();
+
+    // Пирамида досчитывается после добавления в конец и урезается после
+    // removeBefore; проверяется весь ряд и случайное окно
+    for (int step = 0; step < 8; ++step)
+    {
+        const int size = graph->data()->size();
+        const QCPGraphData* data = &*graph->data()->constBegin();
+        const int from = std::uniform_int_distribution<int>(0, size / 2)(random);
+        const QPair<int, int> windows[] = {qMakePair(0, size), qMakePair(from, from + size / 2)};
+        for (const QPair<int, int>& window : windows)
+        {
+            plot.xAxis->setRange(data[window.first].key, data[window.second - 1].key);
+            const QVector<QCPGraphData> line = graph->lineData(window.first, window.second);
+            QVERIFY(line.size() < (window.second - window.first) / 4);
+            const QString error = checkEnvelope(line, data + window.first, data + window.second, plot.xAxis);
+            QVERIFY2(error.isEmpty(), qPrintable(QString("Шаг %1: %2").arg(step).arg(error)));
+        }
+
+        append(30000 + 1000 * step);
+        graph->removeBefore((graph->data()->constBegin() + size / 5)->key);
+    }
+}
+
+void TestGraphicEditor::mappedSeriesCorruptHeader_data()
+{
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<quint64>("value");
+    QTest::addColumn<int>("size");
+
+    const int count = int(offsetof(MappedSeries::Header, count));
+    // count * 16 переполняется до малого числа
+    QTest::newRow("count overflow") << count << (quint64(1) << 60) << 8;
+    QTest::newRow("count past file") << count << quint64(1000000) << 8;
+    QTest::newRow("huge block") << int(offsetof(MappedSeries::Header, blockPoints)) << quint64(0xFFFFFFFFu) << 4;
+    QTest::newRow("huge level factor") << int(offsetof(MappedSeries::Header, levelFactor)) << quint64(0xFFFFFFFFu) << 4;
+    QTest::newRow("index past file") << int(offsetof(MappedSeries::Header, indexOffset)) << ~quint64(0) << 8;
+}
+
+void TestGraphicEditor::mappedSeriesCorruptHeader()
+{
+    QFETCH(int, offset);
+    QFETCH(quint64, value);
+    QFETCH(int, size);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath("series.bin");
+    {
+        MappedSeriesWriter writer(fileName);
+        QVERIFY(writer.open());
+        for (int i = 0; i < 5000; ++i)
+            QVERIFY(writer.append(i, i % 7));
+        QVERIFY(writer.close());
+    }
+    QVERIFY(MappedSeries::open(fileName));
+
+    // Поле заголовка в порядке байт этой машины, как пишет MappedSeriesWriter
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(offset));
+    if (size == 8)
+    {
+        QCOMPARE(file.write(reinterpret_cast<const char*>(&value), 8), qint64(8));
+    }
+    else
+    {
+        const quint32 value32 = quint32(value);
+        QCOMPARE(file.write(reinterpret_cast<const char*>(&value32), 4), qint64(4));
+    }
+    file.close();
+
+    QString error;
+    QVERIFY(!MappedSeries::open(fileName, &error));
+    QVERIFY(!error.isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    // Окно не нужно: если платформа не задана явно, рисуем в памяти
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication a(argc, argv);
+
+    TestGraphicEditor test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_graphiceditor.moc"